@@ -5,18 +5,76 @@
 
 #include "src/BleComm.hpp"
 #include "src/SStream.hpp"
+#include "src/StreamBuilder.hpp"
 #include "src/Settings.hpp"
+#include "src/SpscRing.hpp"
+#include "src/WaveformUpload.hpp"
+#include "src/PatternUpload.hpp"
+#include "src/Calibration.hpp"
+#include "src/TactorMap.hpp"
+#include "src/Persistence.hpp"
+#include "src/IsrProfiler.hpp"
+
+#include <new>
 
 using namespace audio_tactile;
 
 
-SStream *g_stream = 0;
+SStream * volatile g_stream = 0;
+
+/*
+ * Streams are built by loop() into static slots, ahead of being
+ * started. ToggleStream() runs from interrupt context and only
+ * resets and publishes g_prepared_stream, so starting and stopping
+ * never touch the heap and take a fixed time. While running, a
+ * stream prepared after a change of the settings takes over from
+ * g_stream at the next cycle boundary, see SStream::render().
+ *
+ * A slot is rebuilt only if it is neither g_stream nor
+ * g_prepared_stream, as an interrupt can make the prepared stream
+ * the playing one at any time. Three slots always leave one free.
+ */
+constexpr int kStreamSlots = 3;
+alignas(SStream) uint8_t g_stream_storage[kStreamSlots][sizeof(SStream)];
+SStream* g_stream_slot[kStreamSlots] = { 0 };
+SStream * volatile g_prepared_stream = 0;
+
+// Incremented for every change of the stream settings, loop()
+// prepares a new stream until g_prepared_version catches up.
+volatile uint32_t g_settings_version = 0;
+volatile uint32_t g_prepared_version = 0;
+
+// Set by a kToggle message that arrives before the stream of its
+// settings is prepared, loop() starts the stream once it is.
+volatile bool g_start_pending = false;
 
 bool g_ble_connected = false;
-bool g_running = false;
+volatile bool g_running = false;
 uint8_t g_volume = 25;
 uint16_t g_volume_lvl = g_volume * g_settings.vol_amplitude / 100;
 uint64_t g_running_since = 0;
+// Seed of the running or last stream, reported in the status
+volatile uint32_t g_stream_seed = 0;
+
+// Waveform played instead of the sine, uploaded over BLE
+WaveformUpload g_waveform;
+
+// Pattern played instead of the shuffled bursts, uploaded over BLE
+PatternUpload g_pattern;
+
+// Per tactor gains, persisted in flash by loop()
+Calibration g_calibration;
+constexpr char kCalibrationFile[] = "/calibration.bin";
+volatile bool g_calibration_changed = false;
+
+// PWM slot of every tactor, persisted in flash by loop()
+TactorMap g_tactor_map;
+constexpr char kTactorMapFile[] = "/tactormap.bin";
+volatile bool g_tactor_map_changed = false;
+
+// Duration of OnPwmSequenceEnd() and the gap between its calls,
+// reported by a kGetIsrProfile message
+IsrProfiler g_isr_profiler;
 
 void setup() {
     
@@ -25,15 +83,10 @@ void setup() {
     nrf_gpio_cfg_output(kLedPinGreen);  
     nrf_gpio_pin_set(kLedPinBlue);
     
+    IsrProfiler::enable();
     PwmTactor.OnSequenceEnd(OnPwmSequenceEnd);
-    PwmTactor.Initialize();
-    
-    // Warning: issue only in Arduino. When using StartPlayback() it crashes.
-    // Looks like NRF_PWM0 module is automatically triggered, and triggering it
-    // again here crashes ISR. Temporary fix is to only use nrf_pwm_task_trigger
-    // for NRF_PWM1 and NRF_PWM2. To fix might need a nRF52 driver update.
-    nrf_pwm_task_trigger(NRF_PWM1, NRF_PWM_TASK_SEQSTART0);
-    nrf_pwm_task_trigger(NRF_PWM2, NRF_PWM_TASK_SEQSTART0);
+    PwmTactor.Initialize(g_settings.samplerate);
+    PwmTactor.StartPlayback();
     
     PuckBatteryMonitor.InitializeLowVoltageInterrupt();
     PuckBatteryMonitor.OnLowBatteryEventListener(LowBatteryWarning);
@@ -42,6 +95,15 @@ void setup() {
     
     SetSilence();
 
+    Storage.Begin();
+    if(Storage.Load(kCalibrationFile, &g_calibration, sizeof(g_calibration)))
+	Serial.println("Loaded tactor calibration.");
+    if(Storage.Load(kTactorMapFile, &g_tactor_map, sizeof(g_tactor_map))) {
+	PwmTactor.SetChannelMap(g_tactor_map.order, g_tactor_map.tactors, g_volume_lvl);
+	Serial.println("Loaded tactor map.");
+    }
+    PrepareStream();
+
     // Configure button to toggle stream
     // Set pin as inputs with an internal pullup.
     nrf_gpio_cfg_input(kTactileSwitchPin, NRF_GPIO_PIN_PULLUP);
@@ -60,44 +122,253 @@ void setup() {
     }
 }
 
+/**
+ * @return PWM level for the current volume, which is both the
+ * silence level and the amplitude of the stimulation
+ */
+uint16_t VolumeLevel() {
+    return PwmTactor.ScaleLevel(g_volume * g_settings.vol_amplitude / 100);
+}
+
 void SetSilence() {
-    g_volume_lvl = g_volume * g_settings.vol_amplitude / 100;
+    g_volume_lvl = VolumeLevel();
+}
+
+/**
+ * Builds a stream for the current settings in a free slot and makes
+ * it the one started by ToggleStream(). Thread context only, as it
+ * allocates the sample cache.
+ */
+void PrepareStream() {
+    const uint32_t version = g_settings_version;
+    
+    int slot = 0;
+    while(g_stream_slot[slot] && (g_stream_slot[slot] == g_stream ||
+				  g_stream_slot[slot] == g_prepared_stream))
+	slot++;
+
+    if(g_stream_slot[slot])
+	g_stream_slot[slot]->~SStream();
+
+    // the BLE task may commit an upload meanwhile, take each buffer
+    // with its size
+    const auto waveform = g_waveform.active();
+    const auto pattern = g_pattern.active();
+    g_stream_slot[slot] = StreamBuilder::build(g_stream_storage[slot], g_settings, g_tactor_map,
+					       VolumeLevel(),
+					       waveform.samples, waveform.size,
+					       g_calibration.slot_gain,
+					       pattern.data, pattern.size);
+    g_prepared_stream = g_stream_slot[slot];
+    g_prepared_version = version;
+}
+
+/**
+ * Called after a change of the settings the stream is built from
+ */
+void StreamSettingsChanged() {
+    g_settings_version++;
 }
 
-void OnPwmSequenceEnd() {
+/**
+ * Changes a setting the stream divides by, if the settings stay
+ * valid(). A running stream takes the settings over at the next
+ * cycle, in the PWM interrupt, so an invalid value must never reach
+ * g_settings.
+ *
+ * @return false if the value was rejected
+ */
+bool SetStreamSetting(uint32_t Settings::* setting, uint32_t value) {
+    Settings settings = g_settings;
+    settings.*setting = value;
+    if(!settings.valid())
+	return false;
+    g_settings.*setting = value;
+    StreamSettingsChanged();
+    return true;
+}
+
+// Number of sample frames in one PWM sequence
+constexpr uint32_t kFramesPerSequence = kNumPwmValues / SStream::samples_per_frame();
+static_assert(kNumPwmValues % SStream::samples_per_frame() == 0,
+	      "PWM sequence must hold whole sample frames");
+
+// Number of PWM samples in one sequence of a single module
+constexpr uint32_t kSamplesPerModule = kNumPwmValues * SStream::kChannelsPerModule;
+
+// Renders the module whose sequence ended. In sync mode the master
+// module's sequence end is the frame clock and all modules are rendered.
+void OnPwmSequenceEnd(uint8_t module) {
+    g_isr_profiler.begin();
+
+    const uint8_t first_module = kPwmSync ? 0 : module;
+    const uint8_t last_module = kPwmSync ? kNumTotalPwm / SStream::kChannelsPerModule - 1 : module;
+    
     if(g_running) {
-	g_stream->next_sample_frame();
-	
-	const auto active_channel = g_stream->current_active_channel();
-	
-	for(uint32_t channel = 0; channel < g_stream->channels(); channel++)
-	    if(channel==active_channel) {
-		uint16_t* cp = PwmTactor.GetChannelPointer(channel);
-		g_stream->set_chan_samples(cp, channel);
-
-		if(!g_settings.chan8) {
-		    uint16_t* cp = PwmTactor.GetChannelPointer(7-channel);
-		    g_stream->set_chan_samples(cp, channel);
-		}
-	    } else {
-		PwmTactor.SilenceChannel(channel, g_volume_lvl);
-		if(!g_settings.chan8)
-		    PwmTactor.SilenceChannel(7-channel, g_volume_lvl);
-		
-	    }
+#if VHP_RENDER_AHEAD
+	PlayRenderedSequence(first_module, last_module);
+#else
+	// a stream prepared for changed settings takes over at the
+	// next cycle boundary, a volume change ramps in right away
+	// slots that already hold the silence are not written again
+	SStream* next = g_prepared_stream;
+	uint16_t* silence_levels;
+	g_stream->set_volume(g_volume_lvl);
+	if(kPwmSync)
+	    g_stream = g_stream->render(PwmTactor.GetBufferPointer(&silence_levels), kFramesPerSequence,
+					next, silence_levels);
+	else
+	    g_stream = g_stream->render_module(PwmTactor.GetModulePointer(module, &silence_levels), module,
+					       kFramesPerSequence, next, silence_levels);
+#endif
     } else {
-	for(uint32_t i = 0; i < g_settings.default_channels; i++)
+	SilenceModules(first_module, last_module);
+    }
+
+    g_isr_profiler.end();
+}
+
+// Writes silence on the channels of the modules. A channel that is
+// already silent at g_volume_lvl is skipped by the Pwm, so a stopped
+// stream costs little more than a compare per channel.
+void SilenceModules(uint8_t first_module, uint8_t last_module) {
+    for(int i = 0; i < PwmTactor.GetNumChannels(); i++) {
+	const int m = PwmTactor.GetChannelModule(i);
+	if(m >= first_module && m <= last_module)
 	    PwmTactor.SilenceChannel(i, g_volume_lvl);
-    }    
+    }
+}
+
+// Incremented for every stream start, so sequences rendered ahead
+// for an earlier stream are recognized.
+volatile uint32_t g_stream_generation = 0;
+
+#if VHP_RENDER_AHEAD
+/*
+ * Render-ahead pipeline: loop() renders whole PWM sequences of all
+ * modules into g_render_ring, OnPwmSequenceEnd() only copies them
+ * into the idle buffer half. BLE and SoftDevice activity that delays
+ * loop() is absorbed by the ring instead of delaying the PWM
+ * interrupt.
+ */
+static_assert(kPwmSync, "VHP_RENDER_AHEAD needs VHP_PWM_SYNC, a rendered sequence holds all modules");
+
+struct RenderedSequence {
+    uint32_t generation;
+    uint16_t samples[kNumTotalPwm / SStream::kChannelsPerModule * kSamplesPerModule];
+};
+
+SpscRing<RenderedSequence, VHP_RENDER_AHEAD> g_render_ring;
+
+// Sequences that were due while the ring was empty, counted from the
+// first rendered sequence of a stream.
+volatile uint32_t g_render_underruns = 0;
+bool g_render_primed = false;
+
+void PlayRenderedSequence(uint8_t first_module, uint8_t last_module) {
+    const RenderedSequence* sequence;
+    while((sequence = g_render_ring.front()) && sequence->generation != g_stream_generation)
+	g_render_ring.pop();
+
+    if(!sequence) {
+	if(g_render_primed)
+	    g_render_underruns++;
+	SilenceModules(first_module, last_module);
+	return;
+    }
+
+    g_render_primed = true;
+    for(uint8_t m = first_module; m <= last_module; m++)
+	memcpy(PwmTactor.GetModulePointer(m), sequence->samples + m * kSamplesPerModule,
+	       kSamplesPerModule * sizeof(uint16_t));
+    g_render_ring.pop();
 }
 
+// Fills g_render_ring from thread context. A newly started stream is
+// reset here instead of in ToggleStream(), as it may be the stream
+// that is being rendered.
+void RenderAhead() {
+    static uint32_t reset_generation = 0;
+    
+    RenderedSequence* sequence;
+    while(g_running && (sequence = g_render_ring.back())) {
+	// Read the generation before the stream, so a stream that is
+	// replaced meanwhile is rendered under the old generation and
+	// dropped.
+	const uint32_t generation = g_stream_generation;
+	SStream* stream = g_stream;
+	stream->set_volume(g_volume_lvl);
+	if(generation != reset_generation) {
+	    stream->reset(g_stream_seed);
+	    reset_generation = generation;
+	}
+	
+	sequence->generation = generation;
+	SStream* playing = stream->render(sequence->samples, kFramesPerSequence, g_prepared_stream);
+	g_render_ring.push();
+
+	// hand over to the stream of changed settings, unless the
+	// stream was restarted meanwhile
+	if(playing != stream) {
+	    __disable_irq();
+	    if(g_stream_generation == generation)
+		g_stream = playing;
+	    __enable_irq();
+	}
+    }
+}
+#endif
+
 void loop() {
-    // Output battery voltage via serial (debugging)
-    uint16_t battery = PuckBatteryMonitor.MeasureBatteryVoltage();
-    float converted = PuckBatteryMonitor.ConvertBatteryVoltageToFloat(battery);
-    Serial.print("Battery voltage: ");
-    Serial.println(converted);
-    delay(120000);    
+    static bool reported = false;
+    static unsigned long last_report = 0;
+
+    // Output battery voltage via serial (debugging) every 2 minutes
+    if(!reported || millis() - last_report >= 120000) {
+	reported = true;
+	last_report = millis();
+	
+	uint16_t battery = PuckBatteryMonitor.MeasureBatteryVoltage();
+	float converted = PuckBatteryMonitor.ConvertBatteryVoltageToFloat(battery);
+	Serial.print("Battery voltage: ");
+	Serial.println(converted);
+#if VHP_RENDER_AHEAD
+	Serial.print("Render-ahead underruns: ");
+	Serial.println(g_render_underruns);
+#endif
+	Serial.print("Late PWM sequences: ");
+	for(int module = 0; module < 3; module++) {
+	    Serial.print(PwmTactor.GetLateSequences(module));
+	    Serial.print(module < 2 ? " " : "\n");
+	}
+    }
+
+    if(g_calibration_changed) {
+	g_calibration_changed = false;
+	if(!Storage.Save(kCalibrationFile, &g_calibration, sizeof(g_calibration)))
+	    Serial.println("Saving tactor calibration failed.");
+    }
+
+    if(g_tactor_map_changed) {
+	g_tactor_map_changed = false;
+	if(!Storage.Save(kTactorMapFile, &g_tactor_map, sizeof(g_tactor_map)))
+	    Serial.println("Saving tactor map failed.");
+    }
+    
+    if(g_prepared_version != g_settings_version)
+	PrepareStream();
+
+    if(g_start_pending && g_prepared_version == g_settings_version) {
+	g_start_pending = false;
+	StartStream();
+    }
+    
+#if VHP_RENDER_AHEAD
+    RenderAhead();
+    delay(1);
+#else
+    delay(10);
+#endif
 }
 
 void LowBatteryWarning() {
@@ -156,21 +427,21 @@ void ToggleStream() {
 	g_running = false;    
 	nrf_gpio_pin_clear(kLedPinGreen);    
 	Serial.println("Stream is running. Stopping.");
-	delete g_stream;
     } else {
 	nrf_gpio_pin_set(kLedPinGreen);
 	Serial.println("Starting Stream.");
-	g_stream = new SStream(g_settings.chan8,
-			       g_settings.samplerate,
-			       g_settings.stimfreq,
-			       g_settings.stimduration,
-			       g_settings.cycleperiod,
-			       g_settings.pauzecycleperiod,
-			       g_settings.pauzedcycles,
-			       g_settings.jitter,
-			       g_volume * g_settings.vol_amplitude / 100,
-			       g_settings.test_mode,
-			       g_settings.single_channel);
+	SStream* stream = g_prepared_stream;
+	g_stream_seed = g_settings.seed ? g_settings.seed : micros();
+	PwmTactor.ResetLateSequences();
+#if VHP_RENDER_AHEAD
+	g_render_primed = false;
+	g_render_underruns = 0;
+#else
+	stream->set_volume(g_volume_lvl);
+	stream->reset(g_stream_seed);
+#endif
+	g_stream = stream;
+	g_stream_generation++;
 	g_running = true;
 	g_running_since = millis(); 
     }
@@ -190,7 +461,17 @@ void SendStatus() {
 	running_period = millis() - g_running_since;
     }
     
-    BleCom.tx_message().WriteStatus(g_running, running_period, battery_voltage_float);
+    uint32_t late_sequences[3];
+    for(int module = 0; module < 3; module++)
+	late_sequences[module] = PwmTactor.GetLateSequences(module);
+#if VHP_RENDER_AHEAD
+    const uint32_t underruns = g_render_underruns;
+#else
+    const uint32_t underruns = 0;
+#endif
+    
+    BleCom.tx_message().WriteStatus(g_running, running_period, battery_voltage_float, g_stream_seed,
+				    late_sequences, underruns);
     BleCom.SendTxMessage();
 }
 
@@ -198,6 +479,8 @@ void HandleMessage(const Message& message) {
     switch (message.type()) {
     case MessageType::kVolume:
 	message.Read(&g_volume);
+	// the playing stream ramps to the new level, see
+	// SStream::set_volume()
 	SetSilence();    
 	Serial.print("Message Volume: ");
 	Serial.println(g_volume);
@@ -209,53 +492,205 @@ void HandleMessage(const Message& message) {
 	break;
     case MessageType::kToggle:
 	Serial.println("Message: Toggle.");
-	ToggleStream();
+	// settings sent just before must be in the started stream,
+	// loop() starts it when it has been prepared
+	if(g_start_pending)
+	    g_start_pending = false;  // toggled back before it started
+	else if(!g_running && g_prepared_version != g_settings_version)
+	    g_start_pending = true;
+	else
+	    ToggleStream();
 	break;
     case MessageType::k8Channel:
 	message.Read(&g_settings.chan8);
+	StreamSettingsChanged();
 	Serial.print("Message 8 Channel: ");
 	Serial.println(g_settings.chan8);
 	break;
-    case MessageType::kStimFreq:
-	message.Read(&g_settings.stimfreq);
+    case MessageType::kStimFreq: {
+	uint32_t stimfreq = 0;
+	message.Read(&stimfreq);
+	const bool ok = SetStreamSetting(&Settings::stimfreq, stimfreq);
 	Serial.print("Message StimFreq:");
-	Serial.println(g_settings.stimfreq);
+	Serial.print(stimfreq);
+	Serial.println(ok ? "" : ", rejected");
 	break;
+    }
     case MessageType::kStimDur:
 	message.Read(&g_settings.stimduration);
+	StreamSettingsChanged();
 	Serial.print("Message StimDur:");
 	Serial.println(g_settings.stimduration);
 	break;
-    case MessageType::kCyclePeriod:
-	message.Read(&g_settings.cycleperiod);
+    case MessageType::kRampDur:
+	message.Read(&g_settings.rampduration);
+	StreamSettingsChanged();
+	Serial.print("Message RampDur:");
+	Serial.println(g_settings.rampduration);
+	break;
+    case MessageType::kCyclePeriod: {
+	uint32_t cycleperiod = 0;
+	message.Read(&cycleperiod);
+	const bool ok = SetStreamSetting(&Settings::cycleperiod, cycleperiod);
 	Serial.print("Message CyclePeriod:");
-	Serial.println(g_settings.cycleperiod);
+	Serial.print(cycleperiod);
+	Serial.println(ok ? "" : ", rejected");
 	break;
-    case MessageType::kPauzeCyclePeriod:
-	message.Read(&g_settings.pauzecycleperiod);
+    }
+    case MessageType::kPauzeCyclePeriod: {
+	uint32_t pauzecycleperiod = 0;
+	message.Read(&pauzecycleperiod);
+	const bool ok = SetStreamSetting(&Settings::pauzecycleperiod, pauzecycleperiod);
 	Serial.print("Message PauzeCyclePeriod:");
-	Serial.println(g_settings.pauzecycleperiod);
+	Serial.print(pauzecycleperiod);
+	Serial.println(ok ? "" : ", rejected");
 	break;
+    }
     case MessageType::kPauzedCycles:
 	message.Read(&g_settings.pauzedcycles);
+	StreamSettingsChanged();
 	Serial.print("Message PauzeCycles:");
 	Serial.println(g_settings.pauzedcycles);
 	break;
     case MessageType::kJitter:
 	message.Read(&g_settings.jitter);
+	StreamSettingsChanged();
 	Serial.print("Message Jitter:");
 	Serial.println(g_settings.jitter);
 	break;
     case MessageType::kSingleChannel:
 	message.Read(&g_settings.single_channel);
+	StreamSettingsChanged();
 	Serial.print("Message Single Channel:");
 	Serial.println(g_settings.single_channel);
 	break;	
+    case MessageType::kSeed:
+	message.Read(&g_settings.seed);
+	Serial.print("Message Seed:");
+	Serial.println(g_settings.seed);
+	break;
     case MessageType::kTestMode:
 	message.Read(&g_settings.test_mode);
+	StreamSettingsChanged();
 	Serial.print("Message TestMode:");
 	Serial.println(g_settings.test_mode);
 	break;
+    case MessageType::kWaveformChunk: {
+	uint16_t offset;
+	const uint8_t* samples;
+	int bytes;
+	if(!message.ReadWaveformChunk(&offset, &samples, &bytes) ||
+	   !g_waveform.write_chunk(offset, samples, bytes))
+	    Serial.println("Message WaveformChunk: invalid chunk.");
+	break;
+    }
+    case MessageType::kWaveformCommit: {
+	uint16_t samples = 0, checksum = 0;
+	const bool ok = message.ReadWaveformCommit(&samples, &checksum) &&
+	    g_waveform.commit(samples, checksum);
+	if(ok)
+	    StreamSettingsChanged();
+	Serial.print("Message WaveformCommit: ");
+	Serial.print(samples);
+	Serial.println(ok ? " samples" : " samples, rejected");
+	BleCom.tx_message().WriteWaveformCommit(ok, g_waveform.size());
+	BleCom.SendTxMessage();
+	break;
+    }
+    case MessageType::kPatternChunk: {
+	uint16_t offset;
+	const uint8_t* data;
+	int bytes;
+	if(!message.ReadPatternChunk(&offset, &data, &bytes) ||
+	   !g_pattern.write_chunk(offset, data, bytes))
+	    Serial.println("Message PatternChunk: invalid chunk.");
+	break;
+    }
+    case MessageType::kPatternCommit: {
+	uint16_t size = 0, checksum = 0;
+	const bool ok = message.ReadPatternCommit(&size, &checksum) &&
+	    g_pattern.commit(size, checksum);
+	if(ok)
+	    StreamSettingsChanged();
+	Serial.print("Message PatternCommit: ");
+	Serial.print(size);
+	Serial.println(ok ? " bytes" : " bytes, rejected");
+	BleCom.tx_message().WritePatternCommit(ok, g_pattern.size());
+	BleCom.SendTxMessage();
+	break;
+    }
+    case MessageType::kTactorGain: {
+	uint8_t tactor = 0;
+	uint16_t gain = 0;
+	if(message.ReadTactorGain(&tactor, &gain) && g_calibration.set_tactor_gain(tactor, gain, g_tactor_map)) {
+	    g_calibration_changed = true;
+	    StreamSettingsChanged();
+	}
+	Serial.print("Message TactorGain: ");
+	Serial.print(tactor);
+	Serial.print(" ");
+	Serial.println(gain);
+	break;
+    }
+    case MessageType::kGetTactorGains:
+	Serial.println("Message: GetTactorGains.");
+	BleCom.tx_message().WriteTactorGains(g_calibration, g_tactor_map);
+	BleCom.SendTxMessage();
+	break;
+    case MessageType::kTactorMap: {
+	const uint8_t* slots;
+	uint32_t tactors = 0;
+	const TactorMap previous = g_tactor_map;
+	const bool ok = message.ReadTactorMap(&slots, &tactors) && g_tactor_map.set(slots, tactors);
+	if(ok) {
+	    // the gains follow the tactors to their new slots
+	    g_calibration.remap(previous, g_tactor_map);
+	    PwmTactor.SetChannelMap(g_tactor_map.order, g_tactor_map.tactors, g_volume_lvl);
+	    g_calibration_changed = true;
+	    g_tactor_map_changed = true;
+	    StreamSettingsChanged();
+	}
+	Serial.println(ok ? "Message TactorMap." : "Message TactorMap: rejected.");
+	BleCom.tx_message().WriteTactorMap(ok, g_tactor_map);
+	BleCom.SendTxMessage();
+	break;
+    }
+    case MessageType::kGetTactorMap:
+	Serial.println("Message: GetTactorMap.");
+	BleCom.tx_message().WriteTactorMap(true, g_tactor_map);
+	BleCom.SendTxMessage();
+	break;
+    case MessageType::kChannelGroups: {
+	const uint8_t* groups;
+	uint32_t tactors = 0;
+	const bool ok = message.ReadChannelGroups(&groups, &tactors) &&
+	    (tactors == 0 || ChannelMap::valid_groups(groups, tactors));
+	if(ok) {
+	    g_settings.group_count = tactors;
+	    std::copy(groups, groups + tactors, g_settings.groups);
+	    StreamSettingsChanged();
+	}
+	Serial.print("Message ChannelGroups: ");
+	Serial.print(tactors);
+	Serial.println(ok ? " tactors" : " tactors, rejected");
+	break;
+    }
+    case MessageType::kGetIsrProfile: {
+	bool reset = false;
+	message.ReadGetIsrProfile(&reset);
+	Serial.println("Message: GetIsrProfile.");
+
+	// a consistent copy, the PWM interrupt updates the profile
+	__disable_irq();
+	const IsrProfiler::Stats stats = g_isr_profiler.stats();
+	if(reset)
+	    g_isr_profiler.reset();
+	__enable_irq();
+
+	BleCom.tx_message().WriteIsrProfile(stats, SystemCoreClock);
+	BleCom.SendTxMessage();
+	break;
+    }
     case MessageType::kGetSettingsBatch:
 	Serial.println("Message: GetSettings.");
 	BleCom.tx_message().WriteSettings(g_settings);
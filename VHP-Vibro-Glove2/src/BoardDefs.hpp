@@ -3,6 +3,30 @@
 #ifndef BOARDDEFS_HPP_
 #define BOARDDEFS_HPP_
 
+// Length of a PWM sequence (per channel, per ping-pong half) in
+// samples. Longer sequences lower the PWM interrupt rate.
+#ifndef VHP_PWM_FRAME_LENGTH
+#define VHP_PWM_FRAME_LENGTH 8
+#endif
+
+// When 1, the three PWM modules are started together and a single
+// module's sequence end drives the stream, see PwmTactor.hpp.
+#ifndef VHP_PWM_SYNC
+#define VHP_PWM_SYNC 0
+#endif
+
+// Number of PWM sequences rendered ahead by loop(), 0 renders in the
+// PWM interrupt. Must be a power of two.
+#ifndef VHP_RENDER_AHEAD
+#define VHP_RENDER_AHEAD 0
+#endif
+
+// Sine synthesis: 0 plays a table of samplerate / stimfreq samples, 1
+// uses a phase accumulator so stimfreq plays exactly, 2 as 1 with
+// linear interpolation. See SampleCache.hpp.
+#ifndef VHP_DDS
+#define VHP_DDS 0
+#endif
 
 
 // Output sequence for board Apollo84 hardware
@@ -36,10 +60,22 @@ namespace audio_tactile {
     
     // Number of ADC samples per buffer.
     constexpr int kAdcDataSize = 64;
-    // Number of PWM samples for each channel per buffer.
-    constexpr int kNumPwmValues = 8;
+    // Number of PWM samples for each channel per buffer. Can be
+    // overridden at compile time with -DVHP_PWM_FRAME_LENGTH=<n>.
+    constexpr int kNumPwmValues = VHP_PWM_FRAME_LENGTH;
+    static_assert(kNumPwmValues == 8 || kNumPwmValues == 32 ||
+		  kNumPwmValues == 64 || kNumPwmValues == 128,
+		  "VHP_PWM_FRAME_LENGTH must be 8, 32, 64 or 128");
+    // Run the PWM modules from a single frame clock.
+    constexpr bool kPwmSync = VHP_PWM_SYNC;
+    // Sine synthesis method, a SampleCache::Synthesis.
+    constexpr int kSynthesis = VHP_DDS;
+    static_assert(kSynthesis >= 0 && kSynthesis <= 2, "VHP_DDS must be 0, 1 or 2");
     // Number of PWM channels.
     constexpr int kNumTotalPwm = 12;
+    // Silence level of a PWM slot that holds samples in a buffer half, above
+    // any PWM level. See Pwm::SilenceChannel() and SStream::render().
+    constexpr uint16_t kNotSilent = 0xFFFF;
     // Max length of a TactilePattern pattern string, not including null terminator.
     constexpr int kMaxTactilePatternLength = 15;
     // Max length of a device name string, not including null terminator.
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "BoardDefs.hpp"
+#include "TactorMap.hpp"
+
+#ifndef CALIBRATION_HPP_
+#define CALIBRATION_HPP_
+
+/**
+ * Calibration - per tactor gain, to even out tactors and amplifiers
+ *
+ * Gains are Q15 (32768 = 1.0) and only attenuate. They are stored per
+ * PWM slot, so a gain stays with the physical tactor whatever the
+ * stream channel driving it. Tactors are addressed through a tactor
+ * map, tactor t is connected to PWM slot order[t], see TactorMap.hpp.
+ * The default map is the 8 tactors of order_pairs.
+ *
+ * SStream scales the stimulation around the silence level, silence
+ * itself is not affected.
+ */
+struct Calibration {
+    enum {
+	kUnityGain = 1 << 15,
+	kNumSlots = audio_tactile::kNumTotalPwm
+    };
+
+    Calibration() {
+	std::fill(std::begin(slot_gain), std::end(slot_gain), (uint16_t) kUnityGain);
+    }
+
+    /**
+     * @return false if tactor or gain is out of range
+     */
+    bool set_tactor_gain(uint32_t tactor, uint32_t gain, const TactorMap& map = TactorMap()) {
+	if(tactor >= map.tactors || gain > kUnityGain)
+	    return false;
+	slot_gain[map.order[tactor]] = gain;
+	return true;
+    }
+
+    uint16_t tactor_gain(uint32_t tactor, const TactorMap& map = TactorMap()) const {
+	return slot_gain[map.order[tactor]];
+    }
+
+    /**
+     * Moves the gain of every tactor from its slot in `from` to its
+     * slot in `to`, after the tactors were rewired. Slots without a
+     * tactor in `to`, and tactors added by `to`, get unity gain.
+     */
+    void remap(const TactorMap& from, const TactorMap& to) {
+	const uint32_t tactors = std::min(from.tactors, to.tactors);
+	uint16_t gain[TactorMap::kMaxTactors];
+	for(uint32_t tactor = 0; tactor < tactors; tactor++)
+	    gain[tactor] = slot_gain[from.order[tactor]];
+
+	std::fill(std::begin(slot_gain), std::end(slot_gain), (uint16_t) kUnityGain);
+	for(uint32_t tactor = 0; tactor < tactors; tactor++)
+	    slot_gain[to.order[tactor]] = gain[tactor];
+    }
+
+    // gain of each PWM slot, module * 4 + channel
+    uint16_t slot_gain[kNumSlots];
+};
+
+#endif
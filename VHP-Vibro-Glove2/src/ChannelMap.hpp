@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <array>
+#include <algorithm>
+
+#include "BoardDefs.hpp"
+
+#ifndef CHANNELMAP_HPP_
+#define CHANNELMAP_HPP_
+
+/**
+ * ChannelMap - maps the PWM slots of each module to the stream
+ * channel that drives them
+ *
+ * A PWM module has 4 slots (pins), the 3 modules have 12. Tactor t is
+ * wired to slot order[t] and plays stream channel group[t], so
+ * tactors sharing a channel form a mirror group that vibrates
+ * together. The stream has as many channels as there are groups, 1
+ * up to one per slot.
+ *
+ * The slots that are driven are kept per module in a compact table
+ * of entries, so rendering walks the entries of a module without
+ * testing for undriven slots.
+ */
+class ChannelMap {
+public:
+    enum {
+	kNumModules = 3,
+	kChannelsPerModule = 4,
+	kNumSlots = kNumModules * kChannelsPerModule,
+	kMaxChannels = kNumSlots,
+	kNoChannel = 0xFF,  // slot is not driven by the stream
+    };
+
+    /**
+     * A slot driven by the stream
+     */
+    struct Entry {
+	uint8_t slot;     // slot in the module, 0..3
+	uint8_t channel;  // stream channel
+    };
+
+    /**
+     * @param order - PWM slot (0..11) of each tactor, see TactorMap.hpp
+     * @param group - stream channel of each tactor, see valid_groups()
+     * @param tactors - number of tactors, 1..kNumSlots
+     */
+    ChannelMap(const uint16_t* order, const uint8_t* group, uint32_t tactors) {
+	build_(order, group, tactors);
+    }
+
+    /**
+     * @param order - physical channel (0..11) for each of the 8
+     *         logical channels, see order_pairs in BoardDefs.hpp
+     * @param chan8 - True selects 8 independent channels, False
+     *         results in 2 x 4 channels mirrored
+     */
+    ChannelMap(const uint16_t* order, bool chan8) {
+	uint8_t group[kNumSlots];
+	mirror_groups(group, 8, chan8);
+	build_(order, group, 8);
+    }
+
+    /**
+     * The 8 tactors of order_pairs in BoardDefs.hpp, as
+     * ChannelMap(order_pairs, chan8)
+     */
+    explicit ChannelMap(bool chan8) : ChannelMap(order_pairs, chan8) {}
+
+    /**
+     * mirror_groups() - default groups of `tactors` tactors: all
+     * independent, or mirrored around the middle so tactor n - 1 - t
+     * plays channel t, as the 2 x 4 channels of chan8 == false
+     *
+     * @param group - receives the channel of each tactor
+     * @param tactors - number of tactors, 1..kNumSlots
+     * @param independent - true gives every tactor its own channel
+     */
+    static void mirror_groups(uint8_t* group, uint32_t tactors, bool independent) {
+	for(uint32_t t = 0; t < tactors; t++)
+	    group[t] = (independent || t < (tactors + 1) / 2) ? t : tactors - 1 - t;
+    }
+
+    /**
+     * valid_groups() - checks a group table: every tactor plays a
+     * channel below kMaxChannels and the channels used are 0..n-1
+     * without gaps, so the stream schedules no channel that drives
+     * nothing
+     *
+     * @return true if group can be passed to the constructor
+     */
+    static bool valid_groups(const uint8_t* group, uint32_t tactors) {
+	if(tactors == 0 || tactors > kNumSlots)
+	    return false;
+	bool used[kMaxChannels] = { false };
+	uint32_t channels = 0;
+	for(uint32_t t = 0; t < tactors; t++) {
+	    if(group[t] >= kMaxChannels)
+		return false;
+	    used[group[t]] = true;
+	    channels = std::max<uint32_t>(channels, group[t] + 1);
+	}
+	return std::all_of(used, used + channels, [](bool u) { return u; });
+    }
+
+    /**
+     * @return stream channel that drives `slot` of `module`, or
+     * kNoChannel
+     */
+    uint8_t source(uint32_t module, uint32_t slot) const {
+	return source_[module * kChannelsPerModule + slot];
+    }
+
+    /**
+     * @return number of stream channels, 1..kMaxChannels
+     */
+    uint32_t channels() const { return channels_; }
+
+    /**
+     * @return first driven slot of module
+     */
+    const Entry* begin(uint32_t module) const { return &entries_[first_[module]]; }
+
+    /**
+     * @return end of the driven slots of module
+     */
+    const Entry* end(uint32_t module) const { return &entries_[first_[module + 1]]; }
+
+private:
+    void build_(const uint16_t* order, const uint8_t* group, uint32_t tactors) {
+	std::fill(source_.begin(), source_.end(), (uint8_t) kNoChannel);
+
+	channels_ = 1;
+	for(uint32_t t = 0; t < tactors; t++) {
+	    source_[order[t]] = group[t];
+	    channels_ = std::max<uint32_t>(channels_, group[t] + 1);
+	}
+
+	uint32_t n = 0;
+	for(uint32_t module = 0; module < kNumModules; module++) {
+	    first_[module] = n;
+	    for(uint32_t slot = 0; slot < kChannelsPerModule; slot++)
+		if(source(module, slot) != kNoChannel)
+		    entries_[n++] = Entry{ (uint8_t) slot, source(module, slot) };
+	}
+	first_[kNumModules] = n;
+    }
+
+    std::array<uint8_t, kNumSlots> source_;
+    uint32_t channels_;
+    std::array<Entry, kNumSlots> entries_;
+    // entries_ of module m are [first_[m], first_[m + 1])
+    std::array<uint8_t, kNumModules + 1> first_;
+};
+
+#endif
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <cmath>
+#include <array>
+
+#ifndef ENVELOPE_HPP_
+#define ENVELOPE_HPP_
+
+
+/*
+ * Attack and release envelope of a stimulus.
+ *
+ * A raised cosine ramp of ramp_samples. The ramp is a fixed table of
+ * kTableSize Q15 gains, shared by all envelopes and computed once,
+ * never at PWM interrupt rate, so its RAM does not grow with the
+ * rampduration. Applying it costs a multiply for the table index and
+ * one for the gain per sample.
+ *
+ * Sample n samples from the nearest edge of the stimulus plays at the
+ * gain of its position n / ramp_samples in the table, samples further
+ * away play at full amplitude.
+ */
+
+class Envelope {
+public:
+    
+    explicit Envelope(uint32_t ramp_samples) :
+	samples_(ramp_samples),
+	index_step_(ramp_samples ? (kTableSize << kIndexShift) / ramp_samples : 0),
+	gain_(gain_table_().data())
+	{
+	}
+
+    /**
+     * @return length of the ramp in samples, 0 when there is no ramp
+     */
+    uint32_t samples() const { return samples_; }
+
+    /**
+     * @param sample - value in 0 .. 2 * volume, as from SampleCache
+     * @param n - distance in samples from the nearest edge of the
+     *        stimulus
+     * @return sample with its deviation from volume scaled by the gain
+     */
+    uint16_t apply(uint16_t sample, uint16_t volume, uint32_t n) const {
+	if(n >= samples_)
+	    return sample;
+	const int32_t gain = gain_[(n * index_step_) >> kIndexShift];
+	return (uint16_t) (volume + (((int32_t) sample - volume) * gain >> kQ15Shift));
+    }
+    
+private:
+    constexpr static int kQ15Shift = 15;
+    constexpr static int32_t kQ15One = (1 << kQ15Shift) - 1;
+    constexpr static uint32_t kTableSize = 256;
+    // fraction bits of the table position; n * index_step_ stays below
+    // kTableSize << kIndexShift for n < samples_
+    constexpr static int kIndexShift = 16;
+    static_assert(((uint64_t) kTableSize << kIndexShift) <= UINT32_MAX, "envelope table too large");
+
+    uint32_t samples_;
+    // table entries per sample, in 1 / 2^kIndexShift
+    uint32_t index_step_;
+    const int16_t* gain_;
+
+    /**
+     * @return the raised cosine, entry k at (k + 0.5) / kTableSize of
+     * the ramp
+     */
+    static const std::array<int16_t, kTableSize>& gain_table_() {
+	static const std::array<int16_t, kTableSize> table = [] {
+	    std::array<int16_t, kTableSize> gain;
+	    const double pi = std::atan(1) * 4;
+	    for(uint32_t k = 0; k < kTableSize; k++)
+		gain[k] = (int16_t) std::lround(kQ15One * 0.5 * (1 - std::cos(pi * (k + 0.5) / kTableSize)));
+	    return gain;
+	}();
+	return table;
+    }
+};
+
+#endif
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ARDUINO_ARCH_NRF52
+#include <nrf.h>
+#else
+// host builds, see tests/arduino-mock.hpp
+extern unsigned long g_mock_cycles;
+#endif
+
+#ifndef ISRPROFILER_HPP_
+#define ISRPROFILER_HPP_
+
+/**
+ * IsrProfiler - duration of an interrupt handler and the gap between
+ * its calls, in CPU cycles of the Cortex-M4 DWT cycle counter
+ *
+ * begin() and end() bracket the handler. Both only read the counter
+ * and update a few counters, so the profiler can stay enabled in
+ * normal use. The counter wraps every 67 s at 64 MHz, durations and
+ * gaps are computed modulo 2^32 and are correct as long as they are
+ * shorter.
+ *
+ * Durations are also counted in a log2 histogram: bucket b holds the
+ * durations in [2^(b + kFirstBucketLog2), 2^(b + kFirstBucketLog2 + 1)),
+ * the first bucket everything shorter and the last everything longer.
+ *
+ * On the host the counter is g_mock_cycles.
+ */
+class IsrProfiler {
+public:
+    enum {
+	kBuckets = 16,
+	// 64 cycles, 1 us at 64 MHz
+	kFirstBucketLog2 = 6,
+    };
+
+    struct Stats {
+	// calls of the handler
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	// gaps between the start of consecutive calls
+	uint32_t gaps;
+	uint32_t gap_min;
+	uint32_t gap_max;
+	uint64_t gap_sum;
+	uint32_t histogram[kBuckets];
+
+	uint32_t avg() const { return count ? sum / count : 0; }
+	uint32_t gap_avg() const { return gaps ? gap_sum / gaps : 0; }
+    };
+
+    IsrProfiler() { reset(); }
+
+    /**
+     * Starts the DWT cycle counter, once at startup
+     */
+    static void enable() {
+#ifdef ARDUINO_ARCH_NRF52
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    }
+
+    /**
+     * @return the cycle counter
+     */
+    static uint32_t cycles() {
+#ifdef ARDUINO_ARCH_NRF52
+	return DWT->CYCCNT;
+#else
+	return (uint32_t) g_mock_cycles;
+#endif
+    }
+
+    /**
+     * Call at the start of the handler
+     */
+    void begin() {
+	const uint32_t now = cycles();
+	if(started_) {
+	    const uint32_t gap = now - start_;
+	    stats_.gaps++;
+	    stats_.gap_sum += gap;
+	    if(gap < stats_.gap_min)
+		stats_.gap_min = gap;
+	    if(gap > stats_.gap_max)
+		stats_.gap_max = gap;
+	}
+	start_ = now;
+	started_ = true;
+    }
+
+    /**
+     * Call at the end of the handler
+     */
+    void end() {
+	const uint32_t duration = cycles() - start_;
+	stats_.count++;
+	stats_.sum += duration;
+	if(duration < stats_.min)
+	    stats_.min = duration;
+	if(duration > stats_.max)
+	    stats_.max = duration;
+	stats_.histogram[bucket(duration)]++;
+    }
+
+    /**
+     * @return the statistics since the last reset(), read them with
+     * the handler's interrupt disabled
+     */
+    const Stats& stats() const { return stats_; }
+
+    /**
+     * Clears the statistics, the next gap is measured from the next
+     * begin()
+     */
+    void reset() {
+	memset(&stats_, 0, sizeof(stats_));
+	stats_.min = UINT32_MAX;
+	stats_.gap_min = UINT32_MAX;
+	started_ = false;
+    }
+
+    /**
+     * @return histogram bucket of a duration
+     */
+    static uint32_t bucket(uint32_t duration) {
+	if(duration < (1u << (kFirstBucketLog2 + 1)))
+	    return 0;
+	const uint32_t log2 = 31 - __builtin_clz(duration);
+	return log2 - kFirstBucketLog2 < kBuckets ? log2 - kFirstBucketLog2 : kBuckets - 1;
+    }
+
+private:
+    Stats stats_;
+    uint32_t start_;
+    bool started_;
+};
+
+#endif
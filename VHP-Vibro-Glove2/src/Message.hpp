@@ -32,6 +32,9 @@
 #include "att/Serialize.hpp"
 
 #include "Settings.hpp"
+#include "Calibration.hpp"
+#include "TactorMap.hpp"
+#include "IsrProfiler.hpp"
 
 namespace audio_tactile {
 
@@ -56,7 +59,21 @@ namespace audio_tactile {
 	kGetVolume = 14,
 	kSettingsBatch = 15, 
 	kGetSettingsBatch = 16,
-	kSingleChannel = 17
+	kSingleChannel = 17,
+	kRampDur = 18,
+	kWaveformChunk = 19,
+	kWaveformCommit = 20,
+	kTactorGain = 21,
+	kGetTactorGains = 22,
+	kTactorGains = 23,
+	kSeed = 24,
+	kPatternChunk = 25,
+	kPatternCommit = 26,
+	kGetIsrProfile = 27,
+	kIsrProfile = 28,
+	kTactorMap = 29,
+	kGetTactorMap = 30,
+	kChannelGroups = 31
     };
 
 // Recipients of messages -- Not used, can be removed
@@ -158,16 +175,27 @@ namespace audio_tactile {
 	    ::LittleEndianWriteU32(settings.jitter, dest); dest += 4;
 	    *dest = settings.test_mode ? 1 : 0; dest++;	    
 	    ::LittleEndianWriteU32(settings.single_channel, dest); dest += 4;
-
+	    ::LittleEndianWriteU32(settings.rampduration, dest); dest += 4;
+	    ::LittleEndianWriteU32(settings.seed, dest); dest += 4;
+	    *dest = settings.group_count; dest++;
+	    for(uint32_t tactor = 0; tactor < settings.group_count; tactor++) {
+		*dest = settings.groups[tactor]; dest++;
+	    }
 	    
 	    bytes_[3] = dest - (bytes_ + kHeaderSize);
 	    set_type(MessageType::kSettingsBatch);
 	}
 
-	// Writes a kStatus message
+	// Writes a kStatus message, seed is the seed of the running or
+	// last stream. late_sequences are the PWM sequences per module
+	// refilled too late and underruns the sequences the render-ahead
+	// ring had none for, both since the start of that stream.
 	void WriteStatus(const bool running,
 			 const uint64_t& running_since,
-			 const float battery_voltage) {
+			 const float battery_voltage,
+			 const uint32_t seed,
+			 const uint32_t (&late_sequences)[3],
+			 const uint32_t underruns) {
 
     
 	    uint8_t* dest = bytes_ + kHeaderSize;
@@ -175,12 +203,161 @@ namespace audio_tactile {
 	    *dest = running ? 1 : 0; dest++;
 	    ::LittleEndianWriteU64(running_since, dest); dest += 8;
 	    ::LittleEndianWriteF32(battery_voltage, dest); dest += 4;
+	    ::LittleEndianWriteU32(seed, dest); dest += 4;
+	    for(uint32_t late : late_sequences) {
+		::LittleEndianWriteU32(late, dest); dest += 4;
+	    }
+	    ::LittleEndianWriteU32(underruns, dest); dest += 4;
 
 	    bytes_[3] = dest - (bytes_ + kHeaderSize);
 	    set_type(MessageType::kStatusBatch);
 	}
   
   
+	// Writes a kWaveformCommit reply: 1 if the waveform was accepted,
+	// followed by the number of samples of the active waveform
+	void WriteWaveformCommit(bool ok, uint16_t samples) {
+	    uint8_t* dest = bytes_ + kHeaderSize;
+
+	    *dest = ok ? 1 : 0; dest++;
+	    ::LittleEndianWriteU16(samples, dest); dest += 2;
+
+	    bytes_[3] = dest - (bytes_ + kHeaderSize);
+	    set_type(MessageType::kWaveformCommit);
+	}
+
+	// Writes a kPatternCommit reply: 1 if the pattern was accepted,
+	// followed by the size in bytes of the active pattern
+	void WritePatternCommit(bool ok, uint16_t size) {
+	    uint8_t* dest = bytes_ + kHeaderSize;
+
+	    *dest = ok ? 1 : 0; dest++;
+	    ::LittleEndianWriteU16(size, dest); dest += 2;
+
+	    bytes_[3] = dest - (bytes_ + kHeaderSize);
+	    set_type(MessageType::kPatternCommit);
+	}
+
+	// Writes a kTactorGains message: the uint16 Q15 gain of every
+	// tactor of the map, in tactor order
+	void WriteTactorGains(const Calibration& calibration, const TactorMap& map) {
+	    uint8_t* dest = bytes_ + kHeaderSize;
+
+	    for(uint32_t tactor = 0; tactor < map.tactors; tactor++) {
+		::LittleEndianWriteU16(calibration.tactor_gain(tactor, map), dest); dest += 2;
+	    }
+
+	    bytes_[3] = dest - (bytes_ + kHeaderSize);
+	    set_type(MessageType::kTactorGains);
+	}
+
+	// Writes a kTactorMap reply: 1 if the uploaded map was accepted,
+	// followed by the uint8 PWM slot of every tactor of the active map
+	void WriteTactorMap(bool ok, const TactorMap& map) {
+	    uint8_t* dest = bytes_ + kHeaderSize;
+
+	    *dest = ok ? 1 : 0; dest++;
+	    for(uint32_t tactor = 0; tactor < map.tactors; tactor++) {
+		*dest = map.order[tactor]; dest++;
+	    }
+
+	    bytes_[3] = dest - (bytes_ + kHeaderSize);
+	    set_type(MessageType::kTactorMap);
+	}
+
+	// Writes a kIsrProfile message: uint32 count, min, avg and max
+	// duration, min, avg and max gap, all in cycles of cpu_hz, the
+	// uint32 cpu_hz and the IsrProfiler::kBuckets uint32 buckets of
+	// the duration histogram. min is 0 without calls.
+	void WriteIsrProfile(const IsrProfiler::Stats& stats, uint32_t cpu_hz) {
+	    uint8_t* dest = bytes_ + kHeaderSize;
+
+	    ::LittleEndianWriteU32(stats.count, dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.count ? stats.min : 0, dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.avg(), dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.max, dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.gaps ? stats.gap_min : 0, dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.gap_avg(), dest); dest += 4;
+	    ::LittleEndianWriteU32(stats.gap_max, dest); dest += 4;
+	    ::LittleEndianWriteU32(cpu_hz, dest); dest += 4;
+	    for(uint32_t b = 0; b < IsrProfiler::kBuckets; b++) {
+		::LittleEndianWriteU32(stats.histogram[b], dest); dest += 4;
+	    }
+
+	    bytes_[3] = dest - (bytes_ + kHeaderSize);
+	    set_type(MessageType::kIsrProfile);
+	}
+
+	// Reads a kGetIsrProfile message: an optional uint8, 1 resets
+	// the profile after it is sent
+	bool ReadGetIsrProfile(bool* reset) const {
+	    *reset = payload_size() >= 1 && payload().data()[0] == 1;
+	    return true;
+	}
+
+	// Reads a kTactorGain message: uint8 tactor, uint16 Q15 gain
+	bool ReadTactorGain(uint8_t* tactor, uint16_t* gain) const {
+	    if(payload_size() != 3)
+		return false;
+	    *tactor = payload().data()[0];
+	    *gain = ::LittleEndianReadU16(payload().data() + 1);
+	    return true;
+	}
+
+	// Reads a kTactorMap message: the uint8 PWM slot of every tactor,
+	// in tactor order, 1 to TactorMap::kMaxTactors tactors
+	bool ReadTactorMap(const uint8_t** slots, uint32_t* tactors) const {
+	    if(payload_size() < 1 || payload_size() > TactorMap::kMaxTactors)
+		return false;
+	    *slots = payload().data();
+	    *tactors = payload_size();
+	    return true;
+	}
+
+	// Reads a kChannelGroups message: the uint8 stream channel of
+	// every tactor, in tactor order. An empty payload returns the
+	// default groups.
+	bool ReadChannelGroups(const uint8_t** groups, uint32_t* tactors) const {
+	    if(payload_size() > TactorMap::kMaxTactors)
+		return false;
+	    *groups = payload().data();
+	    *tactors = payload_size();
+	    return true;
+	}
+
+	// Reads a kWaveformChunk message: uint16 offset of the first
+	// sample, followed by int16 samples
+	bool ReadWaveformChunk(uint16_t* offset, const uint8_t** samples, int* bytes) const {
+	    if(payload_size() < 2)
+		return false;
+	    *offset = ::LittleEndianReadU16(payload().data());
+	    *samples = payload().data() + 2;
+	    *bytes = payload_size() - 2;
+	    return true;
+	}
+
+	// Reads a kWaveformCommit message: uint16 number of samples and
+	// uint16 Fletcher16 of the samples
+	bool ReadWaveformCommit(uint16_t* samples, uint16_t* checksum) const {
+	    if(payload_size() != 4)
+		return false;
+	    *samples = ::LittleEndianReadU16(payload().data());
+	    *checksum = ::LittleEndianReadU16(payload().data() + 2);
+	    return true;
+	}
+  
+	// Reads a kPatternChunk message: uint16 offset of the first
+	// byte, followed by the pattern bytes
+	bool ReadPatternChunk(uint16_t* offset, const uint8_t** data, int* bytes) const {
+	    return ReadWaveformChunk(offset, data, bytes);
+	}
+
+	// Reads a kPatternCommit message: uint16 size in bytes and
+	// uint16 Fletcher16 of the pattern
+	bool ReadPatternCommit(uint16_t* size, uint16_t* checksum) const {
+	    return ReadWaveformCommit(size, checksum);
+	}
+  
 	// Reads uint8 from a BLE message
 	bool Read(uint8_t* v) const {
 	    *v = *payload().data();
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include "ChannelMap.hpp"
+
+#ifndef PATTERN_HPP_
+#define PATTERN_HPP_
+
+/**
+ * Pattern - stimulation protocol as a list of events, played by
+ * SStream instead of the shuffled single channel bursts
+ *
+ * Binary format, little endian, as uploaded over BLE:
+ *
+ *   header: u8 version (kVersion), u8 number of events,
+ *           u16 period in ms, the pattern repeats after the period
+ *   event:  u8 channel mask (bit c is stream channel c),
+ *           u8 amplitude (255 is the full volume),
+ *           u8 waveform (kSine or kUploaded),
+ *           u8 channel mask high (bit c is stream channel 8 + c,
+ *           bits 4..7 reserved, 0),
+ *           u16 onset in ms from the start of the period,
+ *           u16 duration in ms
+ *
+ * The events are decoded once, when the stream is built, into frames
+ * and a list of segments: the frames between two consecutive event
+ * edges, with the event each channel plays in that segment. Playing
+ * a frame then only takes a compare with the next segment start and
+ * the samples of the playing channels. When events overlap on a
+ * channel, the one later in the list plays. A channel the stream
+ * does not have is not played.
+ */
+class Pattern {
+public:
+    enum {
+	kVersion = 1,
+	kHeaderSize = 4,
+	kEventSize = 8,
+	kMaxEvents = 64,
+	kMaxSize = kHeaderSize + kMaxEvents * kEventSize,
+	kNumChannels = ChannelMap::kMaxChannels,
+	kNoEvent = 0xFF,
+    };
+
+    enum Waveform {
+	kSine = 0,		// sine at stimfreq
+	kUploaded = 1		// uploaded waveform, the sine if there is none
+    };
+
+    struct Event {
+	uint16_t channels;
+	uint8_t waveform;
+	// Q15 gain of the amplitude, 1 << 15 is unity
+	int32_t gain;
+	// [onset, offset) in frames from the start of the period
+	uint32_t onset;
+	uint32_t offset;
+    };
+
+    struct Segment {
+	// first frame of the segment
+	uint32_t start;
+	// index in events() for each channel, or kNoEvent
+	std::array<uint8_t, kNumChannels> event;
+    };
+
+    /**
+     * @return true if data is a pattern in the above format: supported
+     * version, size matching the number of events, and every event
+     * with a channel, a known waveform and within the period
+     */
+    static bool valid(const uint8_t* data, uint32_t size) {
+	if(size < kHeaderSize || data[0] != kVersion)
+	    return false;
+
+	const uint32_t events = data[1];
+	const uint32_t period = read_u16_(data + 2);
+	if(events > kMaxEvents || size != kHeaderSize + events * kEventSize || period == 0)
+	    return false;
+
+	for(uint32_t i = 0; i < events; i++) {
+	    const uint8_t* event = data + kHeaderSize + i * kEventSize;
+	    const uint32_t onset = read_u16_(event + 4);
+	    const uint32_t duration = read_u16_(event + 6);
+	    if((event[0] | event[3]) == 0 || event[2] > kUploaded || (event[3] >> (kNumChannels - 8)) != 0 ||
+	       duration == 0 || onset + duration > period)
+		return false;
+	}
+	return true;
+    }
+
+    /**
+     * Empty pattern, SStream plays its own paradigm
+     */
+    Pattern() : frames_(0) {}
+
+    /**
+     * Decodes a pattern, which must be valid()
+     *
+     * @param samplerate - samplerate of PWM driver
+     * @param samples_per_frame - samples in a frame of the stream
+     */
+    Pattern(const uint8_t* data, uint32_t size, uint32_t samplerate, uint32_t samples_per_frame) :
+	frames_(std::max<uint32_t>(1, ms_to_frames_(read_u16_(data + 2), samplerate, samples_per_frame))),
+	events_(data[1])
+	{
+	    std::vector<uint32_t> edges = { 0, frames_ };
+	    for(uint32_t i = 0; i < events_.size(); i++) {
+		const uint8_t* event = data + kHeaderSize + i * kEventSize;
+		const uint32_t onset = read_u16_(event + 4);
+		const uint32_t duration = read_u16_(event + 6);
+
+		auto& e = events_[i];
+		e.channels = event[0] | event[3] << 8;
+		e.gain = (event[1] * (1 << 15) + 127) / 255;
+		e.waveform = event[2];
+		e.onset = std::min(ms_to_frames_(onset, samplerate, samples_per_frame), frames_ - 1);
+		e.offset = std::min(std::max<uint32_t>(ms_to_frames_(onset + duration, samplerate, samples_per_frame),
+						       e.onset + 1), frames_);
+		edges.push_back(e.onset);
+		edges.push_back(e.offset);
+	    }
+
+	    std::sort(edges.begin(), edges.end());
+	    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	    // the last segment starts at frames_, so there always is a
+	    // next segment to compare with
+	    segments_.resize(edges.size());
+	    for(uint32_t s = 0; s < segments_.size(); s++) {
+		segments_[s].start = edges[s];
+		for(uint32_t c = 0; c < kNumChannels; c++)
+		    segments_[s].event[c] = playing_event_(c, edges[s]);
+	    }
+	}
+
+    /**
+     * @return true if there is no pattern
+     */
+    bool empty() const { return frames_ == 0; }
+
+    /**
+     * @return length of the period in frames
+     */
+    uint32_t frames() const { return frames_; }
+
+    const Event& event(uint32_t i) const { return events_[i]; }
+
+    const Segment& segment(uint32_t s) const { return segments_[s]; }
+
+    /**
+     * @return true if any event plays waveform
+     */
+    bool uses(Waveform waveform) const {
+	return std::any_of(events_.begin(), events_.end(),
+			   [=](const Event& e) { return e.waveform == waveform; });
+    }
+
+private:
+    uint32_t frames_;
+    std::vector<Event> events_;
+    std::vector<Segment> segments_;
+
+    static uint32_t read_u16_(const uint8_t* data) {
+	return data[0] | data[1] << 8;
+    }
+
+    static uint32_t ms_to_frames_(uint32_t ms, uint32_t samplerate, uint32_t samples_per_frame) {
+	return (uint32_t) (((uint64_t) ms * samplerate / 1000 + samples_per_frame / 2) / samples_per_frame);
+    }
+
+    /**
+     * @return the last event in the list that plays channel at frame,
+     * or kNoEvent
+     */
+    uint8_t playing_event_(uint32_t channel, uint32_t frame) const {
+	for(uint32_t i = events_.size(); i-- > 0; ) {
+	    const auto& e = events_[i];
+	    if((e.channels & (1 << channel)) && frame >= e.onset && frame < e.offset)
+		return i;
+	}
+	return kNoEvent;
+    }
+};
+
+#endif
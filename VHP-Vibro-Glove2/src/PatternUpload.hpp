@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <array>
+#include <string.h>
+
+#include "att/Serialize.hpp"
+#include "Pattern.hpp"
+
+#ifndef PATTERNUPLOAD_HPP_
+#define PATTERNUPLOAD_HPP_
+
+/**
+ * PatternUpload - stimulation pattern, received in chunks over BLE
+ *
+ * As WaveformUpload: the pattern bytes (see Pattern.hpp) are written
+ * chunk by chunk into the back buffer, commit() checks the Fletcher16
+ * and the format and makes it the active pattern. A failed or partial
+ * upload leaves the active pattern as it is.
+ */
+class PatternUpload {
+public:
+    PatternUpload() : active_(0), size_{0, 0} {}
+
+    /**
+     * Writes bytes to the back buffer
+     *
+     * @param offset - index of the first byte
+     * @return false if the chunk does not fit
+     */
+    bool write_chunk(uint32_t offset, const uint8_t* data, uint32_t bytes) {
+	if(offset + bytes > Pattern::kMaxSize)
+	    return false;
+
+	memcpy(buffer_[active_ ^ 1].data() + offset, data, bytes);
+	return true;
+    }
+
+    /**
+     * Makes the first `size` bytes of the back buffer the active
+     * pattern, if they match checksum and are a valid pattern. 0
+     * bytes returns to the stream's own paradigm.
+     *
+     * @param checksum - Fletcher16, init 1, of the pattern
+     * @return false if the checksum, size or pattern is invalid
+     */
+    bool commit(uint32_t size, uint16_t checksum) {
+	if(size > Pattern::kMaxSize)
+	    return false;
+
+	const uint32_t back = active_ ^ 1;
+	if(size > 0 && (checksum != ::Fletcher16(buffer_[back].data(), size, /*init=*/1) ||
+			!Pattern::valid(buffer_[back].data(), size)))
+	    return false;
+
+	size_[back] = size;
+	active_ = back;
+	return true;
+    }
+
+    /**
+     * The active pattern and its size in bytes
+     */
+    struct Active {
+	const uint8_t* data;  // nullptr if there is none
+	uint32_t size;        // 0 if there is none
+    };
+
+    /**
+     * @return the active pattern with its size, as
+     * WaveformUpload::active()
+     */
+    Active active() const {
+	const uint32_t active = active_;
+	return Active{ size_[active] ? buffer_[active].data() : nullptr, size_[active] };
+    }
+
+    /**
+     * @return the active pattern, nullptr if there is none
+     */
+    const uint8_t* data() const { return active().data; }
+
+    /**
+     * @return size in bytes of the active pattern, 0 if there is none
+     */
+    uint32_t size() const { return active().size; }
+
+private:
+    volatile uint32_t active_;
+    // volatile, as in WaveformUpload
+    volatile uint32_t size_[2];
+    std::array<std::array<uint8_t, Pattern::kMaxSize>, 2> buffer_;
+};
+
+#endif
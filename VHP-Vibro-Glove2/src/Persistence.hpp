@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#ifndef PERSISTENCE_HPP_
+#define PERSISTENCE_HPP_
+
+#include <stdint.h>
+
+#include <Adafruit_LittleFS.h>
+#include <InternalFileSystem.h>
+
+#include "att/Serialize.hpp"
+
+namespace audio_tactile {
+
+/**
+ * Persistence - stores small settings blobs (up to 256 bytes) in the
+ * internal flash file system, so they survive a power cycle
+ *
+ * Every file holds the blob size and its Fletcher16 ahead of the blob,
+ * a blob that does not match is not loaded. This also rejects files
+ * written by a firmware with a different layout of the blob.
+ *
+ * Flash writes take milliseconds and stall the CPU, so Save() should
+ * be called from loop(), not from an interrupt or BLE callback.
+ */
+class Persistence {
+public:
+    bool Begin() {
+	started_ = InternalFS.begin();
+	return started_;
+    }
+
+    /**
+     * @return true if data was loaded from path, false leaves data as
+     * it is
+     */
+    bool Load(const char* path, void* data, uint16_t size) {
+	using namespace Adafruit_LittleFS_Namespace;
+	if(!started_ || size > kMaxSize)
+	    return false;
+	
+	File file(InternalFS);
+	if(!file.open(path, FILE_O_READ))
+	    return false;
+
+	uint8_t header[kHeaderSize];
+	bool ok = file.read(header, kHeaderSize) == kHeaderSize &&
+	    ::LittleEndianReadU16(header) == size;
+
+	// read into a copy, so a corrupt file leaves data untouched
+	uint8_t buffer[kMaxSize];
+	ok = ok && file.read(buffer, size) == size &&
+	    ::LittleEndianReadU16(header + 2) == ::Fletcher16(buffer, size, 1);
+	file.close();
+
+	if(ok)
+	    memcpy(data, buffer, size);
+	return ok;
+    }
+
+    bool Save(const char* path, const void* data, uint16_t size) {
+	using namespace Adafruit_LittleFS_Namespace;
+	if(!started_ || size > kMaxSize)
+	    return false;
+	
+	InternalFS.remove(path);
+	File file(InternalFS);
+	if(!file.open(path, FILE_O_WRITE))
+	    return false;
+
+	uint8_t header[kHeaderSize];
+	::LittleEndianWriteU16(size, header);
+	::LittleEndianWriteU16(::Fletcher16((const uint8_t*) data, size, 1), header + 2);
+	const bool ok = file.write(header, kHeaderSize) == kHeaderSize &&
+	    file.write((const uint8_t*) data, size) == size;
+	file.close();
+	return ok;
+    }
+
+private:
+    enum {
+	kHeaderSize = 4,
+	kMaxSize = 256
+    };
+    
+    bool started_ = false;
+};
+
+Persistence Storage;
+    
+}  // namespace audio_tactile
+
+#endif
@@ -26,8 +26,19 @@
 // The sleeve uses 6 audio amplifiers and a total of 12 PWM channels.
 // There are 3 PWM modules. Each module has 4 channels.
 // The values in each channel can be set independently.
-// The PWM uses: 192B of RAM with 8 PWM values for each channel (3 module * 4
-// channels * 8 values * 2 byte each value)
+// The PWM uses: 384B of RAM with 8 PWM values for each channel (2 halves * 3
+// module * 4 channels * 8 values * 2 byte each value). The number of values is
+// kNumPwmValues, see BoardDefs.hpp.
+//
+// Each module plays its two buffer halves as SEQ0 and SEQ1 in a hardware
+// loop (ping-pong). When one half has ended, the sequence end callback fills
+// it while the other half plays, so the callback has a whole sequence period
+// to finish.
+//
+// By default each module runs at 8 MHz / kTopValue and raises its own sequence
+// end callback. With VHP_PWM_SYNC (see BoardDefs.hpp) the countertop is
+// derived from the stream samplerate, the modules are started together and
+// only kMasterModule raises the callback, which then fills all three modules.
 //
 // An example snippet for initialization steps are are as following:
 // SleeveTactors.Initialize();
@@ -54,6 +65,7 @@
 #define PWMTACTOR_HPP_
 
 #include <stdint.h>
+#include <algorithm>
 
 #include "BoardDefs.hpp"
 #include "nrf_pwm.h"
@@ -62,26 +74,80 @@ namespace {
     extern "C" {
 	static uint8_t pwm_event;
 
-	static void (*pwm_callback)(void);
+	// Per module, the buffer half that is not playing and can be filled.
+	static volatile uint8_t pwm_idle_half[3];
+
+	static void (*pwm_callback)(uint8_t);
 
-	void on_pwm_sequence_end(void (*function)(void)) { pwm_callback = function; }
+	void on_pwm_sequence_end(void (*function)(uint8_t)) { pwm_callback = function; }
 
 	uint8_t get_pwm_event() { return pwm_event; }
-	
+
+	// Per module, the sequences that were refilled after they had
+	// restarted, so (part of) the old samples were played again.
+	static volatile uint32_t pwm_late_sequences[3];
+
+	NRF_PWM_Type* const pwm_modules[3] = { NRF_PWM0, NRF_PWM1, NRF_PWM2 };
+
+	// Counts a late refill of `half` for every module the callback
+	// filled: the hardware loop has started the half again before
+	// the callback returned.
+	void check_late_sequence(uint8_t which_pwm_module, uint8_t half) {
+	    const nrf_pwm_event_t started = half ? NRF_PWM_EVENT_SEQSTARTED1 : NRF_PWM_EVENT_SEQSTARTED0;
+	    for (uint8_t m = 0; m < 3; ++m) {
+		if (!audio_tactile::kPwmSync && m != which_pwm_module) {
+		    continue;
+		}
+		if (nrf_pwm_event_check(pwm_modules[m], started)) {
+		    pwm_late_sequences[m]++;
+		}
+	    }
+	}
+
+	void pwm_sequence_end(uint8_t which_pwm_module, uint8_t half) {
+	    pwm_event = which_pwm_module;
+	    if (audio_tactile::kPwmSync) {
+		/* All modules play in lockstep with the master. */
+		pwm_idle_half[0] = pwm_idle_half[1] = pwm_idle_half[2] = half;
+	    } else {
+		pwm_idle_half[which_pwm_module] = half;
+	    }
+	    pwm_callback(which_pwm_module);
+	    check_late_sequence(which_pwm_module, half);
+	}
+
+	// Clears the SEQSTARTED events of the modules filled by the
+	// callback. The other modules have no interrupts in sync mode,
+	// their events are cleared here by the master.
+	void clear_sequence_started(uint8_t which_pwm_module) {
+	    for (uint8_t m = 0; m < 3; ++m) {
+		if (!audio_tactile::kPwmSync && m != which_pwm_module) {
+		    continue;
+		}
+		nrf_pwm_event_clear(pwm_modules[m], NRF_PWM_EVENT_SEQSTARTED0);
+		nrf_pwm_event_clear(pwm_modules[m], NRF_PWM_EVENT_SEQSTARTED1);
+	    }
+	}
+
 	void pwm_irq_handler(NRF_PWM_Type* pwm_module, uint8_t which_pwm_module) {
-	    /* Triggered when pwm data is trasfered to RAM with Easy DMA. */
-	    if (nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_SEQSTARTED0)) {
-		nrf_pwm_event_clear(pwm_module, NRF_PWM_EVENT_SEQSTARTED0);
+	    /* Triggered when pwm data is trasfered to RAM with Easy DMA. A
+	     * SEQSTARTED event of a half that is set again after its SEQEND
+	     * callback means the callback was late, see check_late_sequence().
+	     */
+	    if (nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_SEQSTARTED0) ||
+		nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_SEQSTARTED1)) {
+		clear_sequence_started(which_pwm_module);
 	    }
-	    /* Triggered after sequence is finished. */
+	    /* Triggered after a sequence is finished. The hardware loop continues
+	     * with the other sequence, so the finished half can be refilled.
+	     */
 	    if (nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_SEQEND0)) {
 		nrf_pwm_event_clear(pwm_module, NRF_PWM_EVENT_SEQEND0);
-		pwm_event = which_pwm_module;
-		/* Do pwm_callback before starting the next sequence, so we can modify the
-		 * buffer before it gets played.
-		 */
-		pwm_callback();
-		nrf_pwm_task_trigger(pwm_module, NRF_PWM_TASK_SEQSTART0);
+		pwm_sequence_end(which_pwm_module, 0);
+	    }
+	    if (nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_SEQEND1)) {
+		nrf_pwm_event_clear(pwm_module, NRF_PWM_EVENT_SEQEND1);
+		pwm_sequence_end(which_pwm_module, 1);
 	    }
 	    /* Triggered when playback is stopped. */
 	    if (nrf_pwm_event_check(pwm_module, NRF_PWM_EVENT_STOPPED)) {
@@ -102,6 +168,7 @@ namespace audio_tactile {
 	enum {
 	    kTopValue = 512,   // Individual PWM values can't be above this number.
 	    kUpsamplingFactor = 0,
+	    kMasterModule = 1,  // Drives the frame clock in sync mode.
 	};
 
 	// Pins on port 1 are always offset by 32. For example pin 7 (P1.07) is 39.
@@ -127,9 +194,13 @@ namespace audio_tactile {
 	    kAmpEnablePin6 = 35   // On 1.03.
 	};
 
+	Pwm() {
+	    BuildChannelTable(order_pairs, sizeof(order_pairs) / sizeof(order_pairs[0]));
+	}
+
 	// This function starts the tactors on the sleeve. Also, initializes amplifier
-	// pins.
-	void Initialize() {
+	// pins. In sync mode the PWM sample rate is set close to `samplerate`.
+	void Initialize(uint32_t samplerate) {
 	    // Configure amplifiers shutdowns pin.
 	    nrf_gpio_cfg_output(kAmpEnablePin1);
 	    nrf_gpio_cfg_output(kAmpEnablePin2);
@@ -146,9 +217,10 @@ namespace audio_tactile {
 	    uint32_t pins_pwm1[4] = {kL3Pin, kR3Pin, kL4Pin, kR4Pin};
 	    uint32_t pins_pwm2[4] = {kL5Pin, kR5Pin, kL6Pin, kR6Pin};
 
-	    InitializePwmModule(NRF_PWM0, pins_pwm0);
-	    InitializePwmModule(NRF_PWM1, pins_pwm1);
-	    InitializePwmModule(NRF_PWM2, pins_pwm2);
+	    ConfigureClock(samplerate);
+	    InitializePwmModule(NRF_PWM0, pins_pwm0, 0);
+	    InitializePwmModule(NRF_PWM1, pins_pwm1, 1);
+	    InitializePwmModule(NRF_PWM2, pins_pwm2, 2);
 
 
 	    // Set the buffer pointers. Need to set it before running PWM.
@@ -156,21 +228,57 @@ namespace audio_tactile {
 	    // <pin 1 PWM> <pin 2 PWM> <pin 3 PWM> <pin 4 PWM> ... <pin 1 PWM>
 	    // Even if we only use two pins (as here), we still need to set values for
 	    // 4 channels, as easy DMA reads them consecutively.
-	    nrf_pwm_seq_cnt_set(NRF_PWM0, 0, kSamplesPerModule);
-	    nrf_pwm_seq_ptr_set(NRF_PWM0, 0, pwm_buffer_);
-	    nrf_pwm_seq_cnt_set(NRF_PWM1, 0, kSamplesPerModule);
-	    nrf_pwm_seq_ptr_set(NRF_PWM1, 0, pwm_buffer_ + kSamplesPerModule);
-	    nrf_pwm_seq_cnt_set(NRF_PWM2, 0, kSamplesPerModule);
-	    nrf_pwm_seq_ptr_set(NRF_PWM2, 0, pwm_buffer_ + 2 * kSamplesPerModule);
+	    // SEQ0 plays the first half of the buffer, SEQ1 the second half.
+	    SetSequences(NRF_PWM0, 0);
+	    SetSequences(NRF_PWM1, 1);
+	    SetSequences(NRF_PWM2, 2);
 
 
 	    // Enable global interrupts for PWM.
 	    NVIC_SetPriority(PWM0_IRQn, kIrqPriority);
-	    NVIC_EnableIRQ(PWM0_IRQn);
 	    NVIC_SetPriority(PWM1_IRQn, kIrqPriority);
-	    NVIC_EnableIRQ(PWM1_IRQn);
 	    NVIC_SetPriority(PWM2_IRQn, kIrqPriority);
-	    NVIC_EnableIRQ(PWM2_IRQn);
+	    if (kPwmSync) {
+		NVIC_EnableIRQ(PWM1_IRQn);
+	    } else {
+		NVIC_EnableIRQ(PWM0_IRQn);
+		NVIC_EnableIRQ(PWM1_IRQn);
+		NVIC_EnableIRQ(PWM2_IRQn);
+	    }
+	}
+
+	// Starts playback. The modules loop their sequences from then on.
+	void StartPlayback() {
+	    if (kPwmSync) {
+		// All three modules are started from one point with interrupts
+		// disabled, so they start within one PWM clock tick of each other and
+		// stay in lockstep. Only the master module raises interrupts, so
+		// restarting NRF_PWM0 (see below) can't double the ISR.
+		__disable_irq();
+		nrf_pwm_task_trigger(NRF_PWM0, NRF_PWM_TASK_SEQSTART0);
+		nrf_pwm_task_trigger(NRF_PWM1, NRF_PWM_TASK_SEQSTART0);
+		nrf_pwm_task_trigger(NRF_PWM2, NRF_PWM_TASK_SEQSTART0);
+		__enable_irq();
+	    } else {
+		// Warning: issue only in Arduino. When triggering all modules it
+		// crashes. Looks like NRF_PWM0 module is automatically triggered, and
+		// triggering it again here crashes ISR. Temporary fix is to only use
+		// nrf_pwm_task_trigger for NRF_PWM1 and NRF_PWM2. To fix might need a
+		// nRF52 driver update.
+		nrf_pwm_task_trigger(NRF_PWM1, NRF_PWM_TASK_SEQSTART0);
+		nrf_pwm_task_trigger(NRF_PWM2, NRF_PWM_TASK_SEQSTART0);
+	    }
+	}
+
+	// Gets the PWM sample rate of a module in Hz.
+	uint32_t GetSampleRate() const {
+	    return (kBaseClock >> clock_) / top_value_;
+	}
+
+	// Scales a PWM level given relative to kTopValue to the current
+	// countertop, so the duty cycle does not depend on the sample rate.
+	uint16_t ScaleLevel(uint32_t level) const {
+	    return level * top_value_ / kTopValue;
 	}
 
 	// In the following, the `channel` arg is a zero-based flat 1D index between 0
@@ -195,27 +303,124 @@ namespace audio_tactile {
 	//         11                     (2, 3)              12
 
 	// Sets values of specific channel to volume, so there is nothing to play.
-	void SilenceChannel(int channel, uint16_t volume) {
-	    uint16_t* dest = GetChannelPointer(channel);
+	// The values are only written if the idle half of the channel does not
+	// hold this silence yet, so a stopped or inactive channel costs a compare
+	// per sequence once both halves are silent.
+	void SilenceChannel(int orig_channel, uint16_t volume) {
+	    const ChannelEntry& entry = channels_[orig_channel];
+	    const uint8_t half = pwm_idle_half[entry.module];
+	    if (silence_level_[half][entry.slot] == volume) {
+		return;
+	    }
+	    silence_level_[half][entry.slot] = volume;
+
+	    uint16_t* dest = entry.pointer[half];
 	    for (int i = 0; i < kNumPwmValues; ++i) {
 		dest[i * kChannelsPerModule] = volume;
 	    }
 	}
 
 
-	// This function is called when sequence is finished.
-	void OnSequenceEnd(void (*function)(void)) {
+	// Gets the number of sequences of `module` that were refilled after the
+	// hardware had started playing them again, since the last reset.
+	uint32_t GetLateSequences(int module) const {
+	    return pwm_late_sequences[module];
+	}
+
+	void ResetLateSequences() {
+	    for (int module = 0; module < kNumModules; ++module) {
+		pwm_late_sequences[module] = 0;
+	    }
+	}
+
+	// This function is called when sequence is finished, with the index of
+	// the module that finished it.
+	void OnSequenceEnd(void (*function)(uint8_t)) {
 	    on_pwm_sequence_end(function);
 	}
 
 
-	// Gets pointer to the start of `channel` in pwm_buffer_.
+	// Gets pointer to the start of `module` in the idle half of pwm_buffer_.
+	// The caller may write all channels of the module, so none of them is
+	// known to be silent afterwards.
+	uint16_t* GetModulePointer(int module) {
+	    const uint8_t half = pwm_idle_half[module];
+	    for (int slot = 0; slot < kChannelsPerModule; ++slot) {
+		silence_level_[half][module * kChannelsPerModule + slot] = kNotSilent;
+	    }
+	    return pwm_buffer_[half] + kSamplesPerModule * module;
+	}
+
+	// Gets pointer to the idle half of pwm_buffer_, all modules one after
+	// the other, for a caller that writes all of them. Sync mode only, where
+	// the modules share their idle half. None of the channels is known to be
+	// silent afterwards.
+	uint16_t* GetBufferPointer() {
+	    const uint8_t half = pwm_idle_half[kMasterModule];
+	    for (int slot = 0; slot < kMaxChannels; ++slot) {
+		silence_level_[half][slot] = kNotSilent;
+	    }
+	    return pwm_buffer_[half];
+	}
+
+	// As GetBufferPointer(), for a caller that keeps the silence levels of
+	// the half up to date, as SStream::render() does: `silence_levels` gets
+	// the level of the silence every slot holds in the half, or kNotSilent.
+	uint16_t* GetBufferPointer(uint16_t** silence_levels) {
+	    const uint8_t half = pwm_idle_half[kMasterModule];
+	    *silence_levels = silence_level_[half];
+	    return pwm_buffer_[half];
+	}
+
+	// As GetModulePointer(), for a caller that keeps the silence levels of
+	// the 4 slots of `module` up to date, see GetBufferPointer().
+	uint16_t* GetModulePointer(int module, uint16_t** silence_levels) {
+	    const uint8_t half = pwm_idle_half[module];
+	    *silence_levels = silence_level_[half] + module * kChannelsPerModule;
+	    return pwm_buffer_[half] + kSamplesPerModule * module;
+	}
+
+	// Gets the number of channels mapped to slots, see SetChannelMap().
+	int GetNumChannels() const {
+	    return num_channels_;
+	}
+
+	// Gets the module that plays `channel`.
+	int GetChannelModule(int orig_channel) const {
+	    return channels_[orig_channel].module;
+	}
+
+	// Gets pointer to the start of `channel` in the idle half of pwm_buffer_,
+	// for the caller to write samples.
 	uint16_t* GetChannelPointer(int orig_channel) {
-	    const auto channel = order_pairs[orig_channel];
-	    
-	    return pwm_buffer_ +
-		kSamplesPerModule * (channel / kChannelsPerModule) +
-		(channel % kChannelsPerModule);
+	    const ChannelEntry& entry = channels_[orig_channel];
+	    const uint8_t half = pwm_idle_half[entry.module];
+
+	    silence_level_[half][entry.slot] = kNotSilent;
+	    return entry.pointer[half];
+	}
+
+	// Maps channels 0 .. channels - 1 to PWM slot order[c] (module * 4 +
+	// module-channel) from now on, instead of order_pairs, see TactorMap.hpp.
+	// Slots that are no longer mapped are set to `volume` in both halves. A
+	// stream of the old map may still write them until a stream of the new
+	// map takes over, which silences them again, see SStream::render().
+	void SetChannelMap(const uint16_t* order, int channels, uint16_t volume) {
+	    __disable_irq();
+	    for (int c = 0; c < num_channels_; ++c) {
+		const uint8_t slot = channels_[c].slot;
+		if (std::find(order, order + channels, slot) != order + channels) {
+		    continue;
+		}
+		for (uint8_t half = 0; half < 2; ++half) {
+		    for (int i = 0; i < kNumPwmValues; ++i) {
+			channels_[c].pointer[half][i * kChannelsPerModule] = volume;
+		    }
+		    silence_level_[half][slot] = volume;
+		}
+	    }
+	    BuildChannelTable(order, channels);
+	    __enable_irq();
 	}
 
 	
@@ -225,35 +430,101 @@ namespace audio_tactile {
 	    kNumModules = 3,
 	    kChannelsPerModule = 4,
 	    kSamplesPerModule = kNumPwmValues * kChannelsPerModule,
+	    kMaxTopValue = 32767,  // COUNTERTOP is 15 bits.
+	    kMaxChannels = kNumModules * kChannelsPerModule,  // One per slot.
+	};
+
+	// Where a channel is played, see channels_.
+	struct ChannelEntry {
+	    uint16_t* pointer[2];  // First sample in each buffer half.
+	    uint8_t module;
+	    uint8_t slot;          // module * kChannelsPerModule + module-channel.
 	};
 
+	static constexpr uint32_t kBaseClock = 16000000;  // 16 MHz PWM clock.
+
+	// Picks the PWM clock and countertop. In sync mode this is the fastest
+	// clock for which the countertop giving `samplerate` fits in
+	// kMaxTopValue, otherwise the fixed 8 MHz and kTopValue.
+	void ConfigureClock(uint32_t samplerate) {
+	    clock_ = NRF_PWM_CLK_8MHz;
+	    top_value_ = kTopValue;
+	    if (!kPwmSync) {
+		return;
+	    }
+
+	    for (int prescaler = NRF_PWM_CLK_16MHz; prescaler <= NRF_PWM_CLK_125kHz; ++prescaler) {
+		const uint32_t clock = kBaseClock >> prescaler;
+		clock_ = static_cast<nrf_pwm_clk_t>(prescaler);
+		top_value_ = (clock + samplerate / 2) / samplerate;
+		if (top_value_ <= kMaxTopValue) {
+		    break;
+		}
+	    }
+	}
+
 	// Internal initialization helper.
-	void InitializePwmModule(NRF_PWM_Type* pwm_module, uint32_t pins[4]) {
+	void InitializePwmModule(NRF_PWM_Type* pwm_module, uint32_t pins[4], int module) {
 	    // Enable the PWM.
 	    nrf_pwm_enable(pwm_module);
 
 	    // Configure the pins.
 	    nrf_pwm_pins_set(pwm_module, pins);
 
-	    // `kTopValue` is half the number of clock ticks per PWM sample. The PWM
-	    // sample value should be in [0, kTopValue], and is the clock tick to flip
+	    // `top_value_` is the number of clock ticks per PWM sample. The PWM
+	    // sample value should be in [0, top_value_], and is the clock tick to flip
 	    // output between high and low (we use NRF_PWM_MODE_UP counter mode). The PWM
-	    // sample rate is 16 MHz / kTopValue.
+	    // sample rate is clock / top_value_.
 	    //
-	    // E.g. with kTopValue = 1024, the sample rate is 15625 Hz.
-	    nrf_pwm_configure(pwm_module, NRF_PWM_CLK_8MHz, NRF_PWM_MODE_UP, kTopValue);
+	    // E.g. with kTopValue = 512 at 8 MHz, the sample rate is 15625 Hz.
+	    nrf_pwm_configure(pwm_module, clock_, NRF_PWM_MODE_UP, top_value_);
 
 	    // Refresh is 1 by default, which means that each PWM pulse is repeated twice.
 	    // Set it to zero to avoid repeats. Also can be set whatever with kNumRepeats.
 	    nrf_pwm_seq_refresh_set(pwm_module, 0, kUpsamplingFactor);
+	    nrf_pwm_seq_refresh_set(pwm_module, 1, kUpsamplingFactor);
 
 	    // Set the decoder. Decoder determines how PWM values are loaded into RAM.
 	    // We set it to individual, meaning that each value represents a separate pin.
 	    nrf_pwm_decoder_set(pwm_module, NRF_PWM_LOAD_INDIVIDUAL, NRF_PWM_STEP_AUTO);
 
-	    // Enable interrupts.
+	    // Enable interrupts. In sync mode only the master module has them.
+	    if (kPwmSync && module != kMasterModule) {
+		return;
+	    }
 	    nrf_pwm_int_enable(pwm_module, NRF_PWM_INT_SEQSTARTED0_MASK);
 	    nrf_pwm_int_enable(pwm_module, NRF_PWM_INT_SEQEND0_MASK);
+	    nrf_pwm_int_enable(pwm_module, NRF_PWM_INT_SEQSTARTED1_MASK);
+	    nrf_pwm_int_enable(pwm_module, NRF_PWM_INT_SEQEND1_MASK);
+	}
+
+	// Points SEQ0 and SEQ1 of `pwm_module` to its part of both buffer
+	// halves. Playing SEQ0 and SEQ1 once is one loop. When the loop is done,
+	// the shortcut restarts SEQ0, so playback continues without software
+	// intervention.
+	void SetSequences(NRF_PWM_Type* pwm_module, int module) {
+	    for (uint8_t seq = 0; seq < 2; ++seq) {
+		nrf_pwm_seq_cnt_set(pwm_module, seq, kSamplesPerModule);
+		nrf_pwm_seq_ptr_set(pwm_module, seq,
+				    pwm_buffer_[seq] + module * kSamplesPerModule);
+		nrf_pwm_seq_end_delay_set(pwm_module, seq, 0);
+	    }
+	    nrf_pwm_loop_set(pwm_module, 1);
+	    nrf_pwm_shorts_set(pwm_module, NRF_PWM_SHORT_LOOPSDONE_SEQSTART0_MASK);
+	}
+
+	// Fills channels_ for channel c played on slot order[c], so the channel
+	// accessors need no division or lookup of the map.
+	void BuildChannelTable(const uint16_t* order, int channels) {
+	    num_channels_ = channels;
+	    for (int c = 0; c < channels; ++c) {
+		const uint8_t module = order[c] / kChannelsPerModule;
+		const uint32_t offset = kSamplesPerModule * module + order[c] % kChannelsPerModule;
+		channels_[c].pointer[0] = pwm_buffer_[0] + offset;
+		channels_[c].pointer[1] = pwm_buffer_[1] + offset;
+		channels_[c].module = module;
+		channels_[c].slot = order[c];
+	    }
 	}
 
 	// Enable all audio amplifiers with a hardware pin.
@@ -267,14 +538,32 @@ namespace audio_tactile {
 	}
 
 
-	// Playback buffer.
+	// Playback buffer, two halves played as SEQ0 and SEQ1.
 	// In "individual" decoder mode, buffer represents 4 channels:
 	// <pin 1 PWM 1>, <pin 2 PWM 1>, <pin 3 PWM 1 >, <pin 4 PWM 1>,
 	// <pin 1 PWM 2>, <pin 2 PWM 2>, ....
 	// Even if we only use two pins, we still need to set values for
 	// 4 channels, as easy DMA reads them consecutively.
 	// The playback on pin 1 will be <pin 1 PWM 1>, <pin 1 PWM 2>.
-	uint16_t pwm_buffer_[kNumModules * kNumPwmValues * kChannelsPerModule];
+	uint16_t pwm_buffer_[2][kNumModules * kNumPwmValues * kChannelsPerModule];
+
+	// Per half and physical channel, the silence level SilenceChannel() last
+	// wrote, or kNotSilent if the channel was handed out for writing since or
+	// the half was never silenced.
+	uint16_t silence_level_[2][kNumModules * kChannelsPerModule] = {
+	    {kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent,
+	     kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent},
+	    {kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent,
+	     kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent, kNotSilent}};
+
+	// Per channel, its module, slot and samples in both halves, rebuilt when
+	// the map changes, see SetChannelMap().
+	ChannelEntry channels_[kMaxChannels];
+	int num_channels_;
+
+	// PWM clock prescaler and countertop, see ConfigureClock().
+	nrf_pwm_clk_t clock_ = NRF_PWM_CLK_8MHz;
+	uint16_t top_value_ = kTopValue;
     };
 
     Pwm PwmTactor;
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+
+#ifndef RANDOM_HPP_
+#define RANDOM_HPP_
+
+
+/*
+ * Random - small deterministic random generator for SStream
+ *
+ * xoshiro128** (Blackman and Vigna): 128 bits of state, a handful of
+ * shifts, xors and two multiplies per 32 bit number. The same seed
+ * gives the same numbers on the nrf52840 and on the host, so a
+ * stimulation session can be replayed exactly from its seed.
+ *
+ * below() draws from [0, bound) without modulo bias using Lemire's
+ * multiply and shift method, which only divides in the rare case a
+ * draw has to be rejected.
+ */
+
+class Random {
+public:
+    // UniformRandomBitGenerator interface
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    explicit Random(uint32_t seed = 0) { this->seed(seed); }
+
+    /**
+     * Restarts the sequence for the given seed. The state is expanded
+     * from the seed by splitmix64, so it is never all zero.
+     */
+    void seed(uint32_t seed) {
+	uint64_t x = seed;
+	for(int i = 0; i < 4; i += 2) {
+	    const uint64_t z = splitmix64_(x);
+	    s_[i] = (uint32_t) z;
+	    s_[i + 1] = (uint32_t) (z >> 32);
+	}
+    }
+
+    /**
+     * @return next 32 bit number
+     */
+    uint32_t operator()() {
+	const uint32_t result = rotl_(s_[1] * 5, 7) * 9;
+	const uint32_t t = s_[1] << 9;
+
+	s_[2] ^= s_[0];
+	s_[3] ^= s_[1];
+	s_[1] ^= s_[2];
+	s_[0] ^= s_[3];
+	s_[2] ^= t;
+	s_[3] = rotl_(s_[3], 11);
+
+	return result;
+    }
+
+    /**
+     * @return uniformly distributed number in [0, bound), 0 if bound
+     * is 0 like Arduino random()
+     */
+    uint32_t below(uint32_t bound) {
+	uint64_t m = (uint64_t) (*this)() * bound;
+	uint32_t low = (uint32_t) m;
+	if(low < bound) {
+	    // 2^32 % bound, the number of draws to reject
+	    const uint32_t threshold = (0u - bound) % bound;
+	    while(low < threshold) {
+		m = (uint64_t) (*this)() * bound;
+		low = (uint32_t) m;
+	    }
+	}
+	return (uint32_t) (m >> 32);
+    }
+
+    /**
+     * Fisher-Yates shuffle of [first, last) with below(), unlike
+     * std::shuffle the same on every standard library
+     */
+    template<typename Iterator>
+    void shuffle(Iterator first, Iterator last) {
+	for(uint32_t i = last - first; i > 1; i--) {
+	    const uint32_t j = below(i);
+	    const auto tmp = first[i - 1];
+	    first[i - 1] = first[j];
+	    first[j] = tmp;
+	}
+    }
+
+private:
+    uint32_t s_[4];
+
+    static uint32_t rotl_(uint32_t x, int k) {
+	return (x << k) | (x >> (32 - k));
+    }
+
+    static uint64_t splitmix64_(uint64_t& x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+    }
+};
+
+#endif
@@ -6,23 +6,45 @@
 #include <algorithm>
 
 #include "SampleCache.hpp"
+#include "Envelope.hpp"
+#include "ChannelMap.hpp"
+#include "Calibration.hpp"
+#include "Random.hpp"
+#include "Pattern.hpp"
+#include "BoardDefs.hpp"
 
 #ifndef SSTREAM_HPP_
 #define SSTREAM_HPP_
 
 /**
- * SStream - class to generate vibration stream on 4 or 8 channels
+ * SStream - class to generate vibration stream on 1 to 12 channels
  *
  * The exact generated pattern is determined by the parameters to the
  * constructor
  *
  * As this class is contructed for usage with Adafruit Feather nRF52
  * PWM driver, sample_frames are used. In a sample_frame, 8 samples
- * have been consumed by the hardware.
+ * have been consumed by the hardware. A PWM sequence of kNumPwmValues
+ * samples holds kNumPwmValues / 8 sample_frames, the sample_frame
+ * stays the unit of stimulus timing whatever the sequence length.
  *
  * next_sample_frame() indicates that a cycle has passed
  * chan_samples() produces the 8 samples for the given channel in the
  * current cycle
+ * render() advances the stream and produces a block of frames for
+ * all channels, mapped to the PWM slots by a ChannelMap. The
+ * ChannelMap sets the number of channels, a channel drives every
+ * tactor of its mirror group.
+ *
+ * Given a next stream, render() hands over to it at the next cycle
+ * boundary: the next stream continues the cycle count, and with it
+ * the pauze cycles, and the random sequence of this stream. Settings
+ * are thus changed while playing by preparing a stream with the new
+ * settings, tables included, outside of the interrupt.
+ *
+ * Given a Pattern, render() plays the pattern's events instead of the
+ * shuffled bursts, see Pattern.hpp. next_sample_frame() and
+ * set_chan_samples() do not play patterns.
  */
 
 class SStream {
@@ -31,8 +53,10 @@ public:
     /**
      * SStream - Create new SStream object
      *
-     * @param chan8 - True selects 8 independent channels, False
-     *         results in 2 x 4 channels mirrored
+     * @param channel_map - tactors and the channel each one plays,
+     *         see ChannelMap.hpp. ChannelMap(chan8) selects the 8
+     *         tactors of order_pairs: true for 8 independent channels,
+     *         false for 2 x 4 channels mirrored.
      * @param samplerate - samplerate of PWM driver
      * @param stimfreq - Frequency of finger stimulation in Hz
      * @param stimduration - Duration of the finger stimulation in ms
@@ -46,9 +70,21 @@ public:
      * @param volume - value for volume, range for valid value is 0..512
      * @param test_mode - don't randomize channel order
      * @param single_channel - when non-zero, only trigger specified channel
+     * @param rampduration - Duration in ms of the raised cosine attack
+     *        and release of every stimulation, 0 switches hard. At most
+     *        half the stimulation duration.
+     * @param waveform - single period of Q15 samples played instead of
+     *        the sine, nullptr plays the sine
+     * @param waveform_size - number of samples in waveform
+     * @param slot_gains - Q15 gain of every PWM slot, see
+     *        Calibration.hpp, nullptr for unity gain
+     * @param pattern - valid Pattern played instead of the bursts,
+     *        nullptr plays the bursts. Only the volume, stimfreq,
+     *        rampduration, waveform and slot_gains apply to a pattern.
+     * @param pattern_size - size of pattern in bytes
      */
     explicit SStream(
-	bool chan8,
+	const ChannelMap& channel_map,
 	uint32_t samplerate,
 	uint32_t stimfreq,
 	uint32_t stimduration,
@@ -58,44 +94,173 @@ public:
 	uint16_t jitter,
 	uint32_t volume,
 	bool test_mode = true,
-	uint16_t single_channel = 0
-	) : frame_counter_(0), cycle_counter_(0), channel_order_{0}, channel_jitter_{0},
-	    chan8_(chan8), samplerate_(samplerate), stimfreq_(stimfreq), stimduration_(stimduration),
+	uint16_t single_channel = 0,
+	uint32_t rampduration = 0,
+	const int16_t* waveform = nullptr,
+	uint32_t waveform_size = 0,
+	const uint16_t* slot_gains = nullptr,
+	const uint8_t* pattern = nullptr,
+	uint32_t pattern_size = 0
+	) : frame_counter_(0), cycle_counter_(0), slot_(0), phase_(0),
+	    current_schedule_(0), next_schedule_ready_(false),
+	    channel_order_{0}, channel_jitter_{0},
+	    channel_map_(channel_map), samplerate_(samplerate), stimfreq_(stimfreq), stimduration_(stimduration),
 	    cycleperiod_(cycleperiod), pauzecycleperiod_(pauzecycleperiod), pauzedcycles_(pauzedcycles),
 	    max_jitter_(jitter * cycleperiod_ / channels() / 1000),
-	    volume_(volume),
+	    volume_(volume), volume_target_(volume), volume_q16_(volume << 16),
+	    volume_step_(0), volume_ramp_frames_(0),
 	    test_mode_(test_mode),
-	    sample_cache_(samplerate, stimfreq)
+	    single_channel_(single_channel),
+	    frames_per_cycle_(samples_per_cycle_() / samples_per_frame_),
+	    samples_per_slot_(samples_per_cycle_() / channels()),
+	    samples_per_stim_(stimduration_ * samplerate_ / 1000),
+	    samples_per_stimperiod_(samplerate_ / stimfreq_),
+	    phase_increment_(SampleCache::dds_increment(samplerate, stimfreq)),
+	    sample_cache_(samplerate, stimfreq, kSynthesis, waveform, waveform_size),
+	    envelope_(std::min(rampduration * samplerate_ / 1000, samples_per_stim_ / 2)),
+	    frames_per_ramp_(div_ceil_frames_(envelope_.samples())),
+	    calibrated_(false),
+	    seed_(0),
+	    pattern_(pattern_size ? Pattern(pattern, pattern_size, samplerate, samples_per_frame_) : Pattern()),
+	    segment_(0),
+	    pattern_phase_{0}
 	{
-	    randomSeed(micros());
+	    slot_gain_.fill(Calibration::kUnityGain);
+	    if(slot_gains) {
+		std::copy(slot_gains, slot_gains + slot_gain_.size(), slot_gain_.begin());
+		calibrated_ = std::any_of(slot_gain_.begin(), slot_gain_.end(),
+					  [](uint16_t gain) { return gain != Calibration::kUnityGain; });
+	    }
 
-	    if(test_mode && single_channel > 0 && single_channel <= max_channels) 
-		std::fill(channel_order_.begin(), channel_order_.end(), single_channel - 1);
-	    else
-		std::iota(channel_order_.begin(), channel_order_.end(), 0);
+	    // sample_cache_ holds the uploaded waveform
+	    if(waveform_size && pattern_.uses(Pattern::kSine))
+		sine_cache_.push_back(SampleCache(samplerate, stimfreq, kSynthesis));
 	    
+	    reset();
+	}
 
-	    if(!test_mode_)
-		shuffle_channel_order_();
-	    
-	    if(max_jitter_ > 0)
-		calc_channel_jitter_();
+    /**
+     * reset() - restart the stream from its first cycle, as if newly
+     * constructed. Does not allocate, so a prepared stream can be
+     * (re)started from interrupt context.
+     *
+     * @param seed - seed of the channel order and jitter. Streams
+     *        with equal settings and seed play the same samples.
+     */
+    void reset(uint32_t seed) {
+	seed_ = seed;
+	random_.seed(seed);
+
+	frame_counter_ = 0;
+	cycle_counter_ = 0;
+	current_schedule_ = 0;
+	next_schedule_ready_ = false;
+	reset_channel_order_();
+	dropped_slots_ = 0;
+	dropped_renders_.fill(0);
+	
+	prepare_schedule_(schedule_[0], cycle_counter_);
+	start_slot_();
+
+	// a started stream plays at its volume from the first frame
+	volume_ = volume_target_;
+	volume_q16_ = volume_target_ << 16;
+	volume_ramp_frames_ = 0;
+
+	// the first rendered frame is the first frame of the pattern
+	if(!pattern_.empty()) {
+	    frame_counter_ = pattern_.frames() - 1;
+	    segment_ = 0;
 	}
+    }
+
+    /**
+     * reset() - as reset(seed), seeded from micros()
+     */
+    void reset() { reset(micros()); }
+
+    /**
+     * @return seed of the last reset()
+     */
+    uint32_t seed() const { return seed_; }
+
+    enum {
+	// frames over which a volume change ramps, 5.5 ms at 46875 Hz
+	kVolumeRampFrames = 32
+    };
+
+    /**
+     * set_volume() - changes the volume of the playing stream. The
+     * silence level and amplitude ramp linearly to the new volume over
+     * kVolumeRampFrames frames, in fixed point steps of a frame, so a
+     * change does not click. The sample table is not recomputed.
+     *
+     * Call from the context that renders the stream, before render().
+     * A stopped stream starts at the volume on reset().
+     *
+     * @param volume - new volume, as the constructor's
+     */
+    void set_volume(uint32_t volume) {
+	if(volume == volume_target_)
+	    return;
+	volume_target_ = volume;
+	volume_step_ = ((int32_t) (volume << 16) - (int32_t) volume_q16_) / kVolumeRampFrames;
+	volume_ramp_frames_ = kVolumeRampFrames;
+    }
+
+    /**
+     * @return volume of the current frame
+     */
+    uint32_t volume() const { return volume_; }
+    
 private:
-    constexpr static size_t max_channels = 8;
+    constexpr static size_t max_channels = ChannelMap::kMaxChannels;
+    
+    /**
+     * Schedule of a single cycle, expressed in frames within the cycle.
+     *
+     * Every channel gets one slot of samples_per_slot_ samples within
+     * a cycle. The slot's channel is playing for frames [onset,
+     * offset), phase is the index in the SampleCache for the onset
+     * frame, or the phase accumulator value with kDds. end is the
+     * first frame of the next slot.
+     */
+    constexpr static SampleCache::Synthesis kSynthesis =
+	static_cast<SampleCache::Synthesis>(audio_tactile::kSynthesis);
+    constexpr static bool kDds = kSynthesis != SampleCache::kTable;
+    
+    struct CycleSchedule {
+	struct Slot {
+	    uint32_t channel;
+	    uint32_t onset;
+	    uint32_t offset;
+	    uint32_t end;
+	    uint32_t phase;
+	};
+	
+	bool pauzed;
+	std::array<Slot, max_channels> slots;
+    };
     
     // internal state
     uint32_t frame_counter_;
     uint32_t cycle_counter_;
-    //uint32_t channel_order_[8];
+    uint32_t slot_;
+    uint32_t phase_;
+
+    // schedule_[current_schedule_] is played, the other one is
+    // prepared ahead for the next cycle
+    std::array<CycleSchedule, 2> schedule_;
+    uint32_t current_schedule_;
+    bool next_schedule_ready_;
+    
     std::array<uint32_t, max_channels> channel_order_;
     
-    //int32_t channel_jitter_[8];
     std::array<int32_t, max_channels> channel_jitter_;
     
     
     // set by constructor
-    const bool chan8_;
+    const ChannelMap channel_map_;
     const uint32_t samplerate_;
     const uint32_t stimfreq_;
     const uint32_t stimduration_;
@@ -103,11 +268,48 @@ private:
     const uint32_t pauzecycleperiod_;
     const uint32_t pauzedcycles_;
     const uint32_t max_jitter_;
-    const uint32_t volume_;
+    // volume of the current frame, ramping to volume_target_ in Q16
+    // steps of volume_step_ for volume_ramp_frames_ more frames
+    uint32_t volume_;
+    uint32_t volume_target_;
+    uint32_t volume_q16_;
+    int32_t volume_step_;
+    uint32_t volume_ramp_frames_;
     constexpr static uint32_t samples_per_frame_ = 8;
     const bool test_mode_;
+    const uint16_t single_channel_;
+
+    // derived from the above by the constructor, so no divisions are
+    // needed per frame
+    const uint32_t frames_per_cycle_;
+    const uint32_t samples_per_slot_;
+    const uint32_t samples_per_stim_;
+    const uint32_t samples_per_stimperiod_;
+    // phase accumulator increment per sample, kDds synthesis only
+    const uint32_t phase_increment_;
     
     const SampleCache sample_cache_;
+    const Envelope envelope_;
+    const uint32_t frames_per_ramp_;
+    std::array<uint16_t, ChannelMap::kNumSlots> slot_gain_;
+    // false if all slot gains are unity
+    bool calibrated_;
+    // slots that the stream taken over from drove and this one does
+    // not, silenced by the next 2 renders of each module, one for
+    // each buffer half, see silence_dropped_()
+    uint16_t dropped_slots_;
+    std::array<uint8_t, ChannelMap::kNumModules> dropped_renders_;
+    uint32_t seed_;
+    Random random_;
+
+    const Pattern pattern_;
+    // sine for Pattern::kSine events, if sample_cache_ holds the
+    // uploaded waveform
+    std::vector<SampleCache> sine_cache_;
+    // playing segment of the pattern
+    uint32_t segment_;
+    // phase of every channel in the pattern, as phase_
+    std::array<uint32_t, max_channels> pattern_phase_;
 
 private:
     /**
@@ -115,87 +317,95 @@ private:
      */
     uint32_t samples_per_cycle_() const { return samplerate_ * cycleperiod_ / 1000; }
 
-    uint32_t samples_per_stimperiod_() const { return samplerate_ / stimfreq_; }
-    
     /**
-     * @return true if the current cycle is pauzed
+     * @return true if the given cycle is pauzed
      */
-    bool cycle_is_pauzed_() const { return cycle_counter_ >= pauzecycleperiod_ - pauzedcycles_; }
+    bool cycle_is_pauzed_(uint32_t cycle) const { return cycle >= pauzecycleperiod_ - pauzedcycles_; }
 
-    /**
-     * @input sample - queried sample number
-     * @return active channel number for queried sample, thus 0 1 2 ... channels within cycle
-     */
-    uint32_t active_channel_number_(uint32_t sample) const { return sample / ( samples_per_cycle_() / channels()); }
+    const CycleSchedule& schedule_now_() const { return schedule_[current_schedule_]; }
 
-    /**
-     * @input  sample - queried sample number
-     * @return active channel for queried sample, thus randomized channels within cycle
-     */
-    uint32_t active_channel_(uint32_t sample) const { return channel_order_[active_channel_number_(sample)]; }
+    const CycleSchedule::Slot& slot_now_() const { return schedule_now_().slots[slot_]; }
 
     /**
-     * @input sample - queried sample number
-     * @input channel - queried channel number
-     * @returns true if the queried channel is active for the queried
-     * sample. Note that an active channel can produce silence when
-     * stimduration has already passed.
+     * @returns true if the current slot's channel is playing in the
+     * current frame. Note that an active channel can produce silence
+     * before its (jittered) onset and after stimduration has passed.
      */
-    bool channel_is_active_(uint32_t sample, uint32_t channel) const { return channel == active_channel_(sample); }
-
+    bool slot_is_playing_() const {
+	return frame_counter_ >= slot_now_().onset && frame_counter_ < slot_now_().offset;
+    }
 
     /**
-     * @input sample - queried sample number
-     * @input channel - queried channel number
-     * @returns true if the queried channel is playing for the queried
-     * sample. Thus true if stimduration is still ongoing.
+     * @returns true if the playing frame is in the attack or release
+     * of a stimulation playing frames [onset, offset)
      */
-    bool channel_is_playing_(uint32_t sample, uint32_t channel) const {
-	return channel_is_active_(sample, channel)
-	    && sample % (samples_per_cycle_() / channels())
-	                < stimduration_ * samplerate_ / 1000; }
+    bool frame_in_ramp_(uint32_t onset, uint32_t offset) const {
+	return frame_counter_ - onset < frames_per_ramp_ ||
+	    offset - frame_counter_ <= frames_per_ramp_;
+    }
     
 public:
+    /**
+     * @return Number of samples per channel in a sample_frame
+     */
+    constexpr static uint32_t samples_per_frame() { return samples_per_frame_; }
+    
     /**
      * @return Total number of unique active channels
      */
-    uint32_t channels() const { return chan8_ ? 8 : 4; }
+    uint32_t channels() const { return channel_map_.channels(); }
 
 
     uint32_t current_active_channel() const {
-	if(cycle_is_pauzed_())
+	if(schedule_now_().pauzed)
 	    return UINT32_MAX;
 
-	return active_channel_(frame_counter_ * samples_per_frame_);
+	return slot_now_().channel;
     }
 	
     
     /**
      * Advances internal state to the next sample frame
+     *
+     * The schedule of the next cycle is prepared in the second frame
+     * of a cycle, so the cycle rollover itself only swaps schedules.
      */
     void next_sample_frame() {
 	frame_counter_++;
 
-	if(frame_counter_  >= samples_per_cycle_() / samples_per_frame_) {
+	if(frame_counter_ >= frames_per_cycle_) {
 	    frame_counter_ = 0;
 
 	    cycle_counter_++;
 	    if(cycle_counter_ >= pauzecycleperiod_)
 		cycle_counter_ = 0;
 
-	    if(!cycle_is_pauzed_()) {	
-		if(!test_mode_)
-		    shuffle_channel_order_();
-
-		if(max_jitter_ > 0)
-		    calc_channel_jitter_();
-	    }
+	    if(!next_schedule_ready_)
+		prepare_next_schedule_();
+	    
+	    current_schedule_ ^= 1;
+	    next_schedule_ready_ = false;
+	    
+	    start_slot_();
+	    return;
 	}
+
+	if(!next_schedule_ready_)
+	    prepare_next_schedule_();
+	
+	while(frame_counter_ >= slot_now_().end)
+	    slot_++;
+
+	if(frame_counter_ == slot_now_().onset)
+	    phase_ = slot_now_().phase;
+	else
+	    phase_ = advance_phase_(phase_);
     }
 
     /**
      * chan_samples() - produces the value for samples_per_frame_
-     * samples in the designated buffer. 
+     * samples in the designated buffer. The slot gains are not
+     * applied, see render().
      *
      * @param chan - queried channel
      * @return pointer to array holding samples_per_frame_ values
@@ -207,49 +417,474 @@ public:
     };
     
     void set_chan_samples(uint16_t* dest, uint32_t chan) const {
-	const int32_t first_sample = (int32_t) ((frame_counter_ * samples_per_frame_)
-						% (samples_per_cycle_() / channels()))  - channel_jitter_[chan];
-
-	if(first_sample < 0 ||
-	   first_sample > (int32_t) (stimduration_ * samplerate_ / 1000))
+	if(chan != slot_now_().channel || !slot_is_playing_())
 	    set_silence_(dest);
 	else {
-	    auto base = first_sample % (samplerate_ / stimfreq_);
+	    uint16_t samples[samples_per_frame_];
+	    frame_samples_(samples);
 	    for(unsigned i=0; i < samples_per_frame_; i++)
-		dest[i*kChannelsPerModule]= sample_cache_.get_sample(base + i, volume_);
+		dest[i*kChannelsPerModule]= samples[i];
 	}
     }
-private:
 
-    void set_silence_(uint16_t* dest) const {
-	for(unsigned i=0; i < samples_per_frame_; i++)
-	    dest[i*kChannelsPerModule]=volume_; // play silence
+    /**
+     * render() - advances the stream by `frames` sample frames and
+     * produces them for all channels, directly in the interleaved
+     * layout of the PWM buffer, with the gain of every slot applied:
+     *
+     *   module_buffers[(module * frames * 8 + sample) * 4 + slot]
+     *
+     * Every slot that is driven by the stream gets either samples or
+     * silence, mirrored channels included. Other slots are left
+     * untouched, but for slots a stream taken over from drove: they
+     * get silence in the first 2 renders, so no burst stays behind in
+     * either buffer half.
+     *
+     * @param module_buffers - buffer of all 3 PWM modules
+     * @param frames - number of sample frames to produce
+     */
+    void render(uint16_t* module_buffers, uint32_t frames) {
+	render_(module_buffers, 0, ChannelMap::kNumModules, frames, nullptr);
     }
 
+    /**
+     * render() - as render(module_buffers, frames), but when the
+     * current cycle (or pattern period) ends within these frames,
+     * the frames from the next cycle on are played by `next`.
+     *
+     * next continues with the cycle after the current one, so the
+     * pauze cycles keep their rhythm, and with the seed and random
+     * sequence of this stream. Taking over costs as much as a cycle
+     * boundary, it does not allocate.
+     *
+     * Given silence_levels, a slot that holds silence at the volume
+     * throughout module_buffers is not written again. Only pass them
+     * for a buffer that keeps what was rendered into it, as the PWM
+     * buffer halves do.
+     *
+     * @param next - stream to hand over to, nullptr or this to play on
+     * @param silence_levels - nullptr, or per slot (module * 4 +
+     *        slot) the level of the silence it holds in all frames of
+     *        module_buffers, kNotSilent if it holds samples. Updated
+     *        for the next render into the same buffer, see
+     *        Pwm::GetBufferPointer().
+     * @return the stream playing after these frames, this or next
+     */
+    SStream* render(uint16_t* module_buffers, uint32_t frames, SStream* next,
+		    uint16_t* silence_levels = nullptr) {
+	return render_(module_buffers, 0, ChannelMap::kNumModules, frames, next, silence_levels);
+    }
+
+    /**
+     * render_module() - as render(), for the 4 slots of a single PWM
+     * module only
+     *
+     * @param dest - first sample of `module` in the PWM buffer
+     * @param module - PWM module (0..2)
+     * @param frames - number of sample frames to produce
+     */
+    void render_module(uint16_t* dest, uint32_t module, uint32_t frames) {
+	render_(dest, module, 1, frames, nullptr);
+    }
+
+    /**
+     * render_module() - as render_module(dest, module, frames),
+     * handing over to next as render(module_buffers, frames, next)
+     *
+     * @param silence_levels - as render(), for the 4 slots of module
+     * @return the stream playing after these frames, this or next
+     */
+    SStream* render_module(uint16_t* dest, uint32_t module, uint32_t frames, SStream* next,
+			   uint16_t* silence_levels = nullptr) {
+	return render_(dest, module, 1, frames, next, silence_levels);
+    }
     
-    /**    		
-     *  Randomize channel order
-     */    
-    void shuffle_channel_order_() {
+private:
+
+    SStream* render_(uint16_t* dest, uint32_t first_module, uint32_t modules, uint32_t frames, SStream* next,
+		     uint16_t* silence_levels = nullptr) {
+	const uint32_t frame_stride = samples_per_frame_ * kChannelsPerModule;
+	const uint32_t module_stride = frames * frame_stride;
+
+	if(!next || next == this || frames_to_cycle_end_() >= frames) {
+	    render_frames_(dest, first_module, modules, frames, module_stride, silence_levels);
+	    if(dropped_slots_)
+		silence_dropped_(dest, first_module, modules, frames, module_stride, silence_levels);
+	    return this;
+	}
+
+	// both streams write part of the frames, all slots are written
+	// and none is known to be silent after
+	const uint32_t played = frames_to_cycle_end_();
+	render_frames_(dest, first_module, modules, played, module_stride, nullptr);
+	next->take_over_(*this);
+	next->render_frames_(dest + played * frame_stride, first_module, modules, frames - played, module_stride,
+			     nullptr);
+	if(silence_levels)
+	    std::fill(silence_levels, silence_levels + modules * kChannelsPerModule, (uint16_t) audio_tactile::kNotSilent);
+	// the frames this stream played included
+	if(next->dropped_slots_)
+	    next->silence_dropped_(dest, first_module, modules, frames, module_stride, nullptr);
+	return next;
+    }
 
-	struct RandInt {
-	    using result_type = uint32_t;
+    /**
+     * Writes silence on the dropped_slots_ of modules, all frames, for
+     * the modules that have renders left to do so
+     */
+    void silence_dropped_(uint16_t* dest, uint32_t first_module, uint32_t modules, uint32_t frames,
+			  uint32_t module_stride, uint16_t* silence_levels) {
+	const uint32_t frame_stride = samples_per_frame_ * kChannelsPerModule;
+
+	bool pending = false;
+	for(uint32_t module = 0; module < modules; module++) {
+	    const auto m = first_module + module;
+	    if(!dropped_renders_[m])
+		continue;
+	    for(uint32_t slot = 0; slot < kChannelsPerModule; slot++)
+		if(dropped_slots_ & (1 << (m * kChannelsPerModule + slot))) {
+		    for(uint32_t frame = 0; frame < frames; frame++)
+			set_silence_(dest + module * module_stride + frame * frame_stride + slot);
+		    if(silence_levels)
+			silence_levels[module * kChannelsPerModule + slot] = audio_tactile::kNotSilent;
+		}
+	    dropped_renders_[m]--;
+	}
+	for(auto renders : dropped_renders_)
+	    pending |= renders > 0;
+	if(!pending)
+	    dropped_slots_ = 0;
+    }
+
+    /**
+     * Renders frames for modules, module_stride samples apart. Given
+     * silence_levels, silence is only written to slots that do not
+     * hold it at the volume yet, and the levels are updated: a slot
+     * that only got silence at a steady volume holds it, one that got
+     * samples does not.
+     */
+    void render_frames_(uint16_t* dest, uint32_t first_module, uint32_t modules, uint32_t frames,
+			uint32_t module_stride, uint16_t* silence_levels) {
+	const uint32_t frame_stride = samples_per_frame_ * kChannelsPerModule;
+	// slots (module * 4 + slot) that got samples
+	uint32_t played = 0;
+	const uint32_t first_volume = volume_;
+	bool steady = true;
+	
+	for(uint32_t frame = 0; frame < frames; frame++, dest += frame_stride) {
+	    if(volume_ramp_frames_) {
+		ramp_volume_();
+		steady &= volume_ == first_volume;
+	    }
 
-	    static constexpr result_type min()  {
-		return 0;
+	    // a channel may drive two slots, compute its samples once
+	    uint16_t samples[max_channels][samples_per_frame_];
+	    // samples of every channel, nullptr plays silence
+	    const uint16_t* channel_samples[max_channels] = { nullptr };
+
+	    if(pattern_.empty()) {
+		next_sample_frame();
+
+		const auto active_channel = current_active_channel();
+		if(active_channel < max_channels && slot_is_playing_()) {
+		    frame_samples_(samples[0]);
+		    channel_samples[active_channel] = samples[0];
+		}
+	    } else {
+		next_pattern_frame_();
+
+		const auto& segment = pattern_.segment(segment_);
+		for(uint32_t chan = 0; chan < channels(); chan++)
+		    if(segment.event[chan] != Pattern::kNoEvent) {
+			pattern_samples_(chan, pattern_.event(segment.event[chan]), samples[chan]);
+			channel_samples[chan] = samples[chan];
+		    }
 	    }
 	    
-	    static constexpr result_type max() {
-		return UINT32_MAX-1;
+	    for(uint32_t module = 0; module < modules; module++) {
+		const auto m = first_module + module;
+		for(auto entry = channel_map_.begin(m); entry != channel_map_.end(m); entry++) {
+		    uint16_t* slot_dest = dest + module * module_stride + entry->slot;
+		    const uint16_t* chan_samples = channel_samples[entry->channel];
+		    const uint32_t slot = module * kChannelsPerModule + entry->slot;
+		    if(chan_samples) {
+			played |= 1 << slot;
+			const int32_t gain = slot_gain_[m * kChannelsPerModule + entry->slot];
+			if(!calibrated_ || gain == Calibration::kUnityGain)
+			    for(unsigned i=0; i < samples_per_frame_; i++)
+				slot_dest[i*kChannelsPerModule] = chan_samples[i];
+			else
+			    for(unsigned i=0; i < samples_per_frame_; i++)
+				slot_dest[i*kChannelsPerModule] = apply_gain_(chan_samples[i], gain);
+		    } else if(!silence_levels || silence_levels[slot] != volume_)
+			set_silence_(slot_dest);
+		}
 	    }
-	    
-	    result_type operator()() {
-		return random(UINT32_MAX);
+	}
+
+	if(!silence_levels)
+	    return;
+	for(uint32_t module = 0; module < modules; module++) {
+	    const auto m = first_module + module;
+	    for(auto entry = channel_map_.begin(m); entry != channel_map_.end(m); entry++) {
+		const uint32_t slot = module * kChannelsPerModule + entry->slot;
+		silence_levels[slot] = steady && !(played & (1 << slot)) ? volume_ : audio_tactile::kNotSilent;
 	    }
-	};
-	
+	}
+    }
+    
+    /**
+     * Advances the volume ramp by a frame, the last step lands exactly
+     * on the target
+     */
+    void ramp_volume_() {
+	if(--volume_ramp_frames_)
+	    volume_q16_ += volume_step_;
+	else
+	    volume_q16_ = volume_target_ << 16;
+	volume_ = (volume_q16_ + (1 << 15)) >> 16;
+    }
+
+    /**
+     * @return sample i of the current frame of a channel at phase
+     */
+    uint16_t sample_(const SampleCache& cache, uint32_t phase, uint32_t i) const {
+	if(kDds)
+	    return cache.get_dds_sample(phase + i * phase_increment_, volume_);
+	return cache.get_sample(phase + i, volume_);
+    }
+
+    /**
+     * Produces the samples_per_frame_ samples of the active channel
+     * in the current frame, with the envelope applied in its attack
+     * and release. Only valid if slot_is_playing_().
+     */
+    void frame_samples_(uint16_t* samples) const {
+	for(unsigned i=0; i < samples_per_frame_; i++)
+	    samples[i] = sample_(sample_cache_, phase_, i);
+
+	apply_envelope_(samples, slot_now_().onset, slot_now_().offset);
+    }
+
+    /**
+     * Applies the envelope to the samples of the current frame, if
+     * it is in the attack or release of a stimulation playing frames
+     * [onset, offset)
+     */
+    void apply_envelope_(uint16_t* samples, uint32_t onset, uint32_t offset) const {
+	if(!frame_in_ramp_(onset, offset))
+	    return;
 	
-	std::shuffle(channel_order_.begin(), channel_order_.end(), RandInt());
+	const uint32_t attack = (frame_counter_ - onset) * samples_per_frame_;
+	const uint32_t release = (offset - frame_counter_) * samples_per_frame_ - 1;
+	for(unsigned i=0; i < samples_per_frame_; i++)
+	    samples[i] = envelope_.apply(samples[i], volume_, std::min(attack + i, release - i));
+    }
+
+    /**
+     * Advances the pattern to the next frame. The phase of the
+     * channels is set at every segment start, where the event of a
+     * channel may change, and advanced otherwise.
+     */
+    void next_pattern_frame_() {
+	frame_counter_++;
+
+	if(frame_counter_ >= pattern_.frames()) {
+	    frame_counter_ = 0;
+	    segment_ = 0;
+	} else if(frame_counter_ >= pattern_.segment(segment_ + 1).start) {
+	    segment_++;
+	} else {
+	    for(uint32_t chan = 0; chan < channels(); chan++)
+		pattern_phase_[chan] = advance_phase_(pattern_phase_[chan]);
+	    return;
+	}
+
+	const auto& segment = pattern_.segment(segment_);
+	for(uint32_t chan = 0; chan < channels(); chan++)
+	    if(segment.event[chan] != Pattern::kNoEvent) {
+		const uint32_t samples = (frame_counter_ - pattern_.event(segment.event[chan]).onset) * samples_per_frame_;
+		pattern_phase_[chan] = kDds ? samples * phase_increment_ : samples % samples_per_stimperiod_;
+	    }
+    }
+
+    /**
+     * @return phase one frame after phase
+     */
+    uint32_t advance_phase_(uint32_t phase) const {
+	if(kDds)
+	    return phase + samples_per_frame_ * phase_increment_;
+	phase += samples_per_frame_;
+	while(phase >= samples_per_stimperiod_)
+	    phase -= samples_per_stimperiod_;
+	return phase;
+    }
+
+    /**
+     * Produces the samples of a channel playing event in the current
+     * frame, with the amplitude and envelope of the event applied
+     */
+    void pattern_samples_(uint32_t chan, const Pattern::Event& event, uint16_t* samples) const {
+	const SampleCache& cache = event.waveform == Pattern::kSine && !sine_cache_.empty() ?
+	    sine_cache_[0] : sample_cache_;
+	for(unsigned i=0; i < samples_per_frame_; i++)
+	    samples[i] = sample_(cache, pattern_phase_[chan], i);
+
+	if(event.gain != Calibration::kUnityGain)
+	    for(unsigned i=0; i < samples_per_frame_; i++)
+		samples[i] = apply_gain_(samples[i], event.gain);
+
+	apply_envelope_(samples, event.onset, event.offset);
+    }
+    
+    /**
+     * @return sample scaled around the silence level by a Q15 gain
+     */
+    uint16_t apply_gain_(uint16_t sample, int32_t gain) const {
+	return (uint16_t) (volume_ + (((int32_t) sample - (int32_t) volume_) * gain >> 15));
+    }
+    
+    /**
+     * @return number of frames rendered before the next cycle, or the
+     * next period of the pattern, starts
+     */
+    uint32_t frames_to_cycle_end_() const {
+	return (pattern_.empty() ? frames_per_cycle_ : pattern_.frames()) - 1 - frame_counter_;
+    }
+
+    /**
+     * Continues where prev ends its cycle: the next frame rendered is
+     * the first frame of the cycle after prev's, or the first frame
+     * of the pattern
+     */
+    void take_over_(const SStream& prev) {
+	seed_ = prev.seed_;
+	random_ = prev.random_;
+	reset_channel_order_();
+
+	// slots prev drove, or still had to silence, that this stream
+	// does not drive
+	dropped_slots_ = prev.dropped_slots_;
+	for(uint32_t slot = 0; slot < ChannelMap::kNumSlots; slot++)
+	    if(prev.channel_map_.source(slot / kChannelsPerModule, slot % kChannelsPerModule) != ChannelMap::kNoChannel)
+		dropped_slots_ |= 1 << slot;
+	for(uint32_t slot = 0; slot < ChannelMap::kNumSlots; slot++)
+	    if(channel_map_.source(slot / kChannelsPerModule, slot % kChannelsPerModule) != ChannelMap::kNoChannel)
+		dropped_slots_ &= ~(1 << slot);
+	dropped_renders_.fill(dropped_slots_ ? 2 : 0);
+
+	// the volume, and a ramp in progress, carry over
+	volume_ = prev.volume_;
+	volume_target_ = prev.volume_target_;
+	volume_q16_ = prev.volume_q16_;
+	volume_step_ = prev.volume_step_;
+	volume_ramp_frames_ = prev.volume_ramp_frames_;
+
+	if(!pattern_.empty()) {
+	    frame_counter_ = pattern_.frames() - 1;
+	    segment_ = 0;
+	    return;
+	}
+
+	uint32_t cycle = prev.cycle_counter_ + 1;
+	if(cycle >= pauzecycleperiod_)
+	    cycle = 0;
+
+	// the last frame of the cycle before, with the schedule of
+	// cycle ready, so the next frame rolls over into it
+	cycle_counter_ = (cycle ? cycle : pauzecycleperiod_) - 1;
+	frame_counter_ = frames_per_cycle_ - 1;
+	current_schedule_ = 0;
+	prepare_schedule_(schedule_[1], cycle);
+	next_schedule_ready_ = true;
+    }
+
+    /**
+     * Channel order and jitter of a newly started stream
+     */
+    void reset_channel_order_() {
+	if(test_mode_ && single_channel_ > 0 && single_channel_ <= channels())
+	    std::fill(channel_order_.begin(), channel_order_.end(), single_channel_ - 1);
+	else
+	    std::iota(channel_order_.begin(), channel_order_.end(), 0);
+	channel_jitter_.fill(0);
+    }
+    
+    /**
+     * Starts playing schedule_now_() from its first slot
+     */
+    void start_slot_() {
+	slot_ = 0;
+	while(frame_counter_ >= slot_now_().end)
+	    slot_++;
+	phase_ = slot_now_().phase;
+    }
+
+    void prepare_next_schedule_() {
+	auto next_cycle = cycle_counter_ + 1;
+	if(next_cycle >= pauzecycleperiod_)
+	    next_cycle = 0;
+
+	prepare_schedule_(schedule_[current_schedule_ ^ 1], next_cycle);
+	next_schedule_ready_ = true;
+    }
+
+    /**
+     * Fill in the schedule for the given cycle. The channel order and
+     * jitter are only renewed for cycles that are not pauzed.
+     *
+     * A slot's channel starts playing at the first frame at or after
+     * slot start + jitter and plays for stimduration, but never
+     * beyond the end of its slot. The last slot ends with the cycle,
+     * so it also holds the frames after the last whole slot, of which
+     * there can be more than one if the cycle does not divide by the
+     * channels.
+     */
+    void prepare_schedule_(CycleSchedule& schedule, uint32_t cycle) {
+	schedule.pauzed = cycle_is_pauzed_(cycle);
+
+	if(!schedule.pauzed) {
+	    if(!test_mode_)
+		shuffle_channel_order_();
+
+	    if(max_jitter_ > 0)
+		calc_channel_jitter_();
+	}
+
+	for(uint32_t k = 0; k < channels(); k++) {
+	    auto& slot = schedule.slots[k];
+	    const uint32_t chan = channel_order_[k];
+	    const uint32_t first = k * samples_per_slot_ + channel_jitter_[chan];
+	    const uint32_t last = first + samples_per_stim_;
+
+	    slot.channel = chan;
+	    slot.end = div_ceil_frames_((k + 1) * samples_per_slot_);
+	    if(k + 1 == channels())
+		slot.end = std::max(slot.end, frames_per_cycle_);
+	    slot.onset = std::min(div_ceil_frames_(first), slot.end);
+	    slot.offset = std::max(slot.onset, std::min(last / samples_per_frame_ + 1, slot.end));
+	    if(kDds)
+		slot.phase = (slot.onset * samples_per_frame_ - first) * phase_increment_;
+	    else
+		slot.phase = (slot.onset * samples_per_frame_ - first) % samples_per_stimperiod_;
+	}
+    }
+
+    static uint32_t div_ceil_frames_(uint32_t samples) {
+	return (samples + samples_per_frame_ - 1) / samples_per_frame_;
+    }
+
+    void set_silence_(uint16_t* dest) const {
+	for(unsigned i=0; i < samples_per_frame_; i++)
+	    dest[i*kChannelsPerModule]=volume_; // play silence
+    }
+
+    
+    /**    		
+     *  Randomize channel order, of the channels the ChannelMap drives
+     */    
+    void shuffle_channel_order_() {
+	random_.shuffle(channel_order_.begin(), channel_order_.begin() + channels());
     }
 
 
@@ -263,12 +898,13 @@ private:
      * This is equivalent to delaying each input with
      * random(cycleperiod/4) * Jitter / 1000
      *
-     * As we support 8 channels, we make this
+     * As we support up to 12 channels, we make this
      * random(cycleperiod / channels)
      */
     
     void calc_channel_jitter_() {
-	std::generate(channel_jitter_.begin(), channel_jitter_.end(), [this]() { return random(max_jitter_); });
+	std::generate(channel_jitter_.begin(), channel_jitter_.begin() + channels(),
+		      [this]() { return random_.below(max_jitter_); });
     }
 	
 };
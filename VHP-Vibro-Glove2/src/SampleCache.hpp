@@ -3,6 +3,9 @@
 #include <stdint.h>
 #include <cmath>
 #include <vector>
+#include <algorithm>
+
+#include "SampleTables.hpp"
 
 #ifndef SAMPLECACHE_HPP_
 #define SAMPLECACHE_HPP_
@@ -17,39 +20,237 @@
  * nrf52840 architecture). Its fast enough because it avoids lots of
  * arithmetics (and specifically divisions) during the sample
  * computation.
+ *
+ * The sine is stored in Q15 fixed point (int16, 32767 ~ 1.0), so
+ * get_sample() is an integer load, multiply and shift. No FPU work or
+ * float to int conversion is done at PWM interrupt rate. See
+ * tests/SampleCache-bench.cpp for a comparison with the former float
+ * table.
+ *
+ * For the (samplerate, stimfreq) pairs of the presets the table is
+ * precomputed in flash, see SampleTables.hpp. Other pairs use no
+ * table of their own: get_sample() computes the phase of sample i as
+ * i times the phase increment of stimfreq and looks it up in the
+ * first quarter of kDdsSineTable, mirrored for the other quarters and
+ * linearly interpolated. That costs a handful of integer operations
+ * more per sample but no RAM, where a table of one period would need
+ * 2 bytes per sample, 94 KB at 1 Hz.
+ *
+ * As SStream restarts the index every samplerate / stimfreq samples,
+ * rounded down, the played frequency is samplerate / (samplerate /
+ * stimfreq), e.g. 250.7 instead of 250 Hz at 46875 Hz. The phase
+ * accumulator synthesis
+ * (kDds, kDdsInterpolated) plays any frequency exactly: the phase is
+ * a 32 bit fraction of a period, of which the upper kDdsTableBits
+ * index a fixed sine table, see get_dds_sample().
+ *
+ * Instead of the sine, a single period of a user defined waveform can
+ * be played. It is resampled once, when the stream is built, into a
+ * table indexed by the sample in the period, so get_sample() is a
+ * single load as for the sine. A period longer than
+ * kMaxWaveformEntries, below 23 Hz at 46875 Hz, would take more RAM
+ * than that per stream: the waveform is then resampled into a table of
+ * 2^kDdsTableBits entries and interpolated at the phase of the sample,
+ * which trades a multiply and an interpolation per sample for the RAM.
+ * The phase accumulator synthesis always uses the latter table.
  */
 
 class SampleCache {
 public:
+
+    /**
+     * Synthesis methods, see VHP_DDS in BoardDefs.hpp
+     */
+    enum Synthesis {
+	kTable = 0,		// get_sample(), index of the sample in the period
+	kDds = 1,		// get_dds_sample(), nearest table entry
+	kDdsInterpolated = 2	// get_dds_sample(), linear interpolation
+    };
+
+    /**
+     * Most entries of a waveform table indexed by the sample in the
+     * period, the period and the 7 samples of slack
+     */
+    constexpr static uint32_t kMaxWaveformEntries = 2 << kDdsTableBits;
     
     explicit SampleCache(
 	uint32_t samplerate,
-	uint32_t stimfreq) :
+	uint32_t stimfreq,
+	Synthesis synthesis = kTable,
+	const int16_t* waveform = nullptr,
+	uint32_t waveform_size = 0) :
 	
-	// +7 samples of slack in the table to handle worst case call
-	// where the table is queried on the last sample of a
-	// stimcycle (and still needs to provide 8 samples)	
-	samples_needed_(samplerate / stimfreq + 7),
-	cache_(samples_needed_)
+	synthesis_(synthesis),
+	table_(waveform_size ? nullptr :
+	       synthesis == kTable ? find_table_(samplerate, stimfreq) : kDdsSineTable),
+	phase_table_(nullptr),
+	increment_(dds_increment(samplerate, stimfreq))
 	{
-	    init_cache_(samplerate, stimfreq);
+	    // +7 samples of slack, as in the precomputed tables, for a
+	    // frame that starts on the last sample of the period
+	    const uint32_t period_entries = samplerate / stimfreq + 7;
+	    if(!waveform_size)
+		return;
+	    if(synthesis == kTable && period_entries <= kMaxWaveformEntries) {
+		cache_.resize(period_entries);
+		init_waveform_(waveform, waveform_size, double(stimfreq) / samplerate);
+		table_ = cache_.data();
+	    } else {
+		cache_.resize((1 << kDdsTableBits) + 1);
+		init_waveform_(waveform, waveform_size, 1.0 / (1 << kDdsTableBits));
+		if(synthesis == kTable)
+		    phase_table_ = cache_.data();
+		else
+		    table_ = cache_.data();
+	    }
 	}
 
+    SampleCache(const SampleCache& other) :
+	synthesis_(other.synthesis_),
+	cache_(other.cache_),
+	table_(other.table_ && !cache_.empty() ? cache_.data() : other.table_),
+	phase_table_(other.phase_table_ ? cache_.data() : nullptr),
+	increment_(other.increment_)
+	{}
+
+    SampleCache& operator=(const SampleCache&) = delete;
+
+    /**
+     * @return true if the sine is a precomputed table of this
+     * (samplerate, stimfreq) pair in flash, always true for the phase
+     * accumulator synthesis of the sine
+     */
+    bool precomputed() const { return table_ && cache_.empty(); }
+
+    /**
+     * @return bytes of RAM of the table, 0 for the sine, at most
+     * kMaxWaveformEntries entries for a waveform at any stimfreq
+     */
+    size_t allocated() const { return cache_.size() * sizeof(int16_t); }
+
+    /**
+     * @return Q15 sine for table entry i of a precomputed table, see
+     * tools/gen-sample-tables.py
+     */
+    static int16_t compute_entry(uint32_t i, uint32_t samplerate, uint32_t stimfreq) {
+	return (int16_t) std::lround(kQ15One * std::sin (2 * pi() * i * stimfreq / samplerate));
+    }
+
 
-    uint16_t get_sample(uint16_t i, uint16_t volume) const {
-	return (uint16_t) (volume + volume * cache_[i]);
+    /**
+     * @param i - index of the sample in the period, up to
+     *        samplerate / stimfreq + 7
+     * @return volume * (1 + sin(i)), thus a value in 0 .. 2 * volume
+     */
+    uint16_t get_sample(uint32_t i, uint16_t volume) const {
+	int32_t q;
+	if(table_)
+	    q = table_[i];
+	else if(phase_table_)
+	    q = interpolate_(phase_table_, i * increment_);
+	else
+	    q = quarter_sine_(i * increment_);
+	return (uint16_t) (volume + ((volume * q) >> kQ15Shift));
+    }
+
+    /**
+     * @return phase increment per sample of the phase accumulator
+     * for stimfreq, rounded to nearest
+     */
+    static uint32_t dds_increment(uint32_t samplerate, uint32_t stimfreq) {
+	return (uint32_t) ((((uint64_t) stimfreq << 32) + samplerate / 2) / samplerate);
+    }
+
+    /**
+     * @param phase - fraction of the period, 2^32 is a full period
+     * @return volume * (1 + sin(phase)), thus a value in 0 .. 2 * volume
+     */
+    uint16_t get_dds_sample(uint32_t phase, uint16_t volume) const {
+	int32_t q;
+	if(synthesis_ == kDdsInterpolated) {
+	    q = interpolate_(table_, phase);
+	} else {
+	    // nearest entry, the last one is the guard entry
+	    q = table_[(uint32_t) (((uint64_t) phase + (1u << (kDdsIndexShift - 1))) >> kDdsIndexShift)];
+	}
+	return (uint16_t) (volume + ((volume * q) >> kQ15Shift));
     }
     
     
 private:
-    const unsigned samples_needed_;    
-    std::vector<float> cache_;
+    constexpr static int kQ15Shift = 15;
+    constexpr static int32_t kQ15One = (1 << kQ15Shift) - 1;
+    constexpr static int kDdsIndexShift = 32 - kDdsTableBits;
+    constexpr static int kDdsFractionShift = kDdsIndexShift - kQ15Shift;
+    static_assert(kDdsFractionShift >= 0, "DDS table too large for a Q15 fraction");
+    // the first quarter of kDdsSineTable, 0 .. pi / 2 included
+    constexpr static int kQuarterTableBits = kDdsTableBits - 2;
+    constexpr static uint32_t kQuarterMask = (1u << 30) - 1;
+    constexpr static int kQuarterIndexShift = 30 - kQuarterTableBits;
+    constexpr static int kQuarterFractionShift = kQuarterIndexShift - kQ15Shift;
+    
+    const Synthesis synthesis_;
+    // only used for a waveform
+    std::vector<int16_t> cache_;
+    // indexed by the sample in the period, or by the phase for the
+    // phase accumulator, nullptr if get_sample() uses the phase
+    const int16_t* table_;
+    // waveform of a period longer than kMaxWaveformEntries played by
+    // get_sample(), nullptr for a table_ or the quarter sine
+    const int16_t* phase_table_;
+    // phase increment per sample of get_sample() without table_
+    const uint32_t increment_;
     
     constexpr static float pi() { return std::atan(1)*4; }
     
-    void init_cache_(uint32_t samplerate, uint32_t stimfreq) {				   
-	for(uint32_t i = 0; i < samples_needed_; i++) 
-	    cache_[i] = std::sin (2 * pi() * i * stimfreq / samplerate);	
+    static const int16_t* find_table_(uint32_t samplerate, uint32_t stimfreq) {
+	for(const auto& table : kSampleTables)
+	    if(table.samplerate == samplerate && table.stimfreq == stimfreq)
+		return table.samples;
+	return nullptr;
+    }
+    
+    /**
+     * @return table entry at phase, linearly interpolated, for a table
+     * of 2^kDdsTableBits + 1 entries
+     */
+    static int32_t interpolate_(const int16_t* table, uint32_t phase) {
+	const uint32_t i = phase >> kDdsIndexShift;
+	const int32_t fraction = (phase >> kDdsFractionShift) & kQ15One;
+	return table[i] + (((table[i + 1] - table[i]) * fraction) >> kQ15Shift);
+    }
+
+    /**
+     * @return Q15 sine at phase, from the first quarter of
+     * kDdsSineTable: the second and fourth quarter run it backwards,
+     * the third and fourth negate it
+     */
+    static int32_t quarter_sine_(uint32_t phase) {
+	const uint32_t quarter = phase >> 30;
+	uint32_t x = phase & kQuarterMask;
+	if(quarter & 1)
+	    x ^= kQuarterMask;
+	const uint32_t i = x >> kQuarterIndexShift;
+	const int32_t fraction = (x >> kQuarterFractionShift) & kQ15One;
+	const int32_t q = kDdsSineTable[i] + (((kDdsSineTable[i + 1] - kDdsSineTable[i]) * fraction) >> kQ15Shift);
+	return quarter & 2 ? -q : q;
+    }
+
+    /**
+     * Fills the table with the waveform, linearly interpolated. Entry
+     * i is at i * periods_per_entry periods: stimfreq / samplerate
+     * when indexed by the sample in the period, 1 / 2^kDdsTableBits
+     * when indexed by the phase.
+     */
+    void init_waveform_(const int16_t* waveform, uint32_t waveform_size, double periods_per_entry) {
+	for(uint32_t i = 0; i < cache_.size(); i++) {
+	    double period;
+	    const double position = std::modf(i * periods_per_entry, &period) * waveform_size;
+	    const uint32_t k = std::min((uint32_t) position, waveform_size - 1);
+	    const double fraction = position - k;
+	    const int32_t next = waveform[(k + 1) % waveform_size];
+	    cache_[i] = (int16_t) std::lround(waveform[k] + fraction * (next - waveform[k]));
+	}
     }
 
     
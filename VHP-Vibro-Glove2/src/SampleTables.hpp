@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+// Generated by tools/gen-sample-tables.py from webui/presets.json,
+// do not edit.
+
+#include <stdint.h>
+
+#ifndef SAMPLETABLES_HPP_
+#define SAMPLETABLES_HPP_
+
+/**
+ * Precomputed Q15 sine of SampleCache for a (samplerate, stimfreq)
+ * pair, samplerate / stimfreq + 7 entries
+ */
+struct SampleTable {
+    uint32_t samplerate;
+    uint32_t stimfreq;
+    const int16_t* samples;
+};
+
+const int16_t kSampleTable_46875_40[1178] = {
+    0, 176, 351, 527, 703, 878, 1054, 1230, 1405, 1581, 1756, 1931,
+    2107, 2282, 2457, 2632, 2808, 2983, 3157, 3332, 3507, 3682, 3856, 4031,
+    4205, 4379, 4553, 4727, 4901, 5074, 5248, 5421, 5594, 5767, 5940, 6113,
+    6285, 6458, 6630, 6802, 6974, 7145, 7317, 7488, 7659, 7829, 8000, 8170,
+    8340, 8510, 8679, 8849, 9018, 9187, 9355, 9523, 9691, 9859, 10026, 10193,
+    10360, 10527, 10693, 10859, 11024, 11190, 11355, 11519, 11684, 11848, 12011, 12175,
+    12337, 12500, 12662, 12824, 12986, 13147, 13307, 13468, 13628, 13787, 13947, 14105,
+    14264, 14422, 14579, 14736, 14893, 15049, 15205, 15361, 15516, 15670, 15824, 15978,
+    16131, 16284, 16436, 16588, 16739, 16890, 17040, 17190, 17339, 17488, 17636, 17784,
+    17931, 18078, 18224, 18370, 18515, 18660, 18804, 18948, 19091, 19233, 19375, 19517,
+    19658, 19798, 19937, 20077, 20215, 20353, 20491, 20627, 20764, 20899, 21034, 21169,
+    21302, 21436, 21568, 21700, 21831, 21962, 22092, 22222, 22350, 22479, 22606, 22733,
+    22859, 22985, 23110, 23234, 23357, 23480, 23602, 23724, 23845, 23965, 24084, 24203,
+    24321, 24439, 24555, 24671, 24787, 24901, 25015, 25128, 25240, 25352, 25463, 25573,
+    25683, 25791, 25899, 26007, 26113, 26219, 26324, 26428, 26532, 26634, 26736, 26837,
+    26938, 27038, 27136, 27234, 27332, 27428, 27524, 27619, 27713, 27806, 27899, 27991,
+    28082, 28172, 28261, 28350, 28437, 28524, 28610, 28695, 28780, 28863, 28946, 29028,
+    29109, 29189, 29269, 29347, 29425, 29502, 29578, 29653, 29727, 29801, 29874, 29945,
+    30016, 30086, 30155, 30224, 30291, 30358, 30423, 30488, 30552, 30615, 30677, 30739,
+    30799, 30859, 30917, 30975, 31032, 31088, 31143, 31197, 31250, 31303, 31354, 31405,
+    31454, 31503, 31551, 31598, 31644, 31689, 31733, 31777, 31819, 31861, 31901, 31941,
+    31980, 32017, 32054, 32090, 32125, 32160, 32193, 32225, 32256, 32287, 32316, 32345,
+    32373, 32399, 32425, 32450, 32474, 32497, 32519, 32540, 32560, 32579, 32598, 32615,
+    32631, 32647, 32662, 32675, 32688, 32700, 32710, 32720, 32729, 32737, 32744, 32750,
+    32755, 32760, 32763, 32765, 32767, 32767, 32767, 32765, 32763, 32759, 32755, 32750,
+    32744, 32737, 32729, 32720, 32710, 32699, 32687, 32674, 32661, 32646, 32630, 32614,
+    32597, 32578, 32559, 32539, 32517, 32495, 32472, 32448, 32423, 32398, 32371, 32343,
+    32315, 32285, 32254, 32223, 32191, 32157, 32123, 32088, 32052, 32015, 31977, 31938,
+    31899, 31858, 31817, 31774, 31731, 31686, 31641, 31595, 31548, 31500, 31451, 31402,
+    31351, 31299, 31247, 31194, 31139, 31084, 31028, 30971, 30914, 30855, 30795, 30735,
+    30673, 30611, 30548, 30484, 30419, 30354, 30287, 30219, 30151, 30082, 30012, 29941,
+    29869, 29796, 29723, 29648, 29573, 29497, 29420, 29342, 29264, 29184, 29104, 29023,
+    28941, 28858, 28775, 28690, 28605, 28519, 28432, 28344, 28255, 28166, 28076, 27985,
+    27893, 27801, 27707, 27613, 27518, 27422, 27326, 27228, 27130, 27031, 26932, 26831,
+    26730, 26628, 26525, 26422, 26317, 26212, 26107, 26000, 25893, 25785, 25676, 25566,
+    25456, 25345, 25233, 25121, 25008, 24894, 24779, 24664, 24548, 24431, 24314, 24196,
+    24077, 23957, 23837, 23716, 23595, 23473, 23350, 23226, 23102, 22977, 22851, 22725,
+    22598, 22471, 22342, 22214, 22084, 21954, 21823, 21692, 21560, 21427, 21294, 21160,
+    21026, 20891, 20755, 20619, 20482, 20345, 20207, 20068, 19929, 19789, 19649, 19508,
+    19366, 19224, 19082, 18939, 18795, 18651, 18506, 18361, 18215, 18069, 17922, 17775,
+    17627, 17479, 17330, 17180, 17031, 16880, 16729, 16578, 16426, 16274, 16121, 15968,
+    15814, 15660, 15506, 15351, 15195, 15040, 14883, 14727, 14569, 14412, 14254, 14095,
+    13937, 13777, 13618, 13458, 13297, 13137, 12976, 12814, 12652, 12490, 12327, 12164,
+    12001, 11837, 11673, 11509, 11344, 11179, 11014, 10849, 10683, 10516, 10350, 10183,
+    10016, 9848, 9681, 9513, 9344, 9176, 9007, 8838, 8669, 8499, 8329, 8159,
+    7989, 7819, 7648, 7477, 7306, 7134, 6963, 6791, 6619, 6447, 6275, 6102,
+    5929, 5757, 5584, 5410, 5237, 5064, 4890, 4716, 4542, 4368, 4194, 4020,
+    3845, 3671, 3496, 3321, 3146, 2972, 2797, 2621, 2446, 2271, 2096, 1920,
+    1745, 1570, 1394, 1219, 1043, 867, 692, 516, 340, 165, -11, -187,
+    -362, -538, -714, -889, -1065, -1240, -1416, -1592, -1767, -1942, -2118, -2293,
+    -2468, -2643, -2818, -2993, -3168, -3343, -3518, -3693, -3867, -4041, -4216, -4390,
+    -4564, -4738, -4912, -5085, -5259, -5432, -5605, -5778, -5951, -6124, -6296, -6469,
+    -6641, -6813, -6984, -7156, -7327, -7498, -7669, -7840, -8010, -8181, -8351, -8520,
+    -8690, -8859, -9028, -9197, -9366, -9534, -9702, -9869, -10037, -10204, -10371, -10537,
+    -10703, -10869, -11035, -11200, -11365, -11530, -11694, -11858, -12021, -12185, -12348, -12510,
+    -12672, -12834, -12996, -13157, -13318, -13478, -13638, -13797, -13956, -14115, -14274, -14432,
+    -14589, -14746, -14903, -15059, -15215, -15370, -15525, -15680, -15834, -15987, -16140, -16293,
+    -16445, -16597, -16748, -16899, -17049, -17199, -17348, -17497, -17645, -17793, -17940, -18087,
+    -18233, -18379, -18524, -18669, -18813, -18957, -19100, -19242, -19384, -19525, -19666, -19807,
+    -19946, -20085, -20224, -20362, -20499, -20636, -20772, -20908, -21043, -21177, -21311, -21444,
+    -21576, -21708, -21840, -21970, -22100, -22230, -22358, -22487, -22614, -22741, -22867, -22992,
+    -23117, -23241, -23365, -23488, -23610, -23731, -23852, -23972, -24092, -24211, -24329, -24446,
+    -24563, -24678, -24794, -24908, -25022, -25135, -25247, -25359, -25470, -25580, -25690, -25798,
+    -25906, -26013, -26120, -26226, -26330, -26435, -26538, -26641, -26743, -26844, -26944, -27044,
+    -27143, -27241, -27338, -27434, -27530, -27625, -27719, -27812, -27905, -27996, -28087, -28177,
+    -28267, -28355, -28443, -28530, -28616, -28701, -28785, -28869, -28951, -29033, -29114, -29194,
+    -29274, -29352, -29430, -29507, -29583, -29658, -29732, -29806, -29878, -29950, -30021, -30091,
+    -30160, -30228, -30295, -30362, -30427, -30492, -30556, -30619, -30681, -30742, -30803, -30862,
+    -30921, -30979, -31035, -31091, -31146, -31200, -31254, -31306, -31357, -31408, -31458, -31506,
+    -31554, -31601, -31647, -31692, -31736, -31779, -31822, -31863, -31904, -31943, -31982, -32020,
+    -32057, -32093, -32128, -32162, -32195, -32227, -32258, -32289, -32318, -32347, -32374, -32401,
+    -32427, -32451, -32475, -32498, -32520, -32541, -32561, -32581, -32599, -32616, -32632, -32648,
+    -32662, -32676, -32689, -32700, -32711, -32721, -32730, -32738, -32745, -32751, -32756, -32760,
+    -32763, -32765, -32767, -32767, -32766, -32765, -32762, -32759, -32755, -32750, -32743, -32736,
+    -32728, -32719, -32709, -32698, -32686, -32673, -32660, -32645, -32629, -32613, -32595, -32577,
+    -32558, -32537, -32516, -32494, -32471, -32447, -32422, -32396, -32369, -32341, -32313, -32283,
+    -32253, -32221, -32189, -32155, -32121, -32086, -32050, -32013, -31975, -31936, -31896, -31856,
+    -31814, -31771, -31728, -31684, -31638, -31592, -31545, -31497, -31448, -31398, -31348, -31296,
+    -31244, -31190, -31136, -31081, -31025, -30968, -30910, -30851, -30792, -30731, -30670, -30607,
+    -30544, -30480, -30415, -30349, -30283, -30215, -30147, -30078, -30007, -29936, -29865, -29792,
+    -29718, -29644, -29569, -29492, -29415, -29338, -29259, -29179, -29099, -29018, -28936, -28853,
+    -28769, -28685, -28599, -28513, -28426, -28339, -28250, -28161, -28070, -27979, -27887, -27795,
+    -27701, -27607, -27512, -27416, -27320, -27222, -27124, -27025, -26925, -26825, -26724, -26622,
+    -26519, -26415, -26311, -26206, -26100, -25993, -25886, -25778, -25669, -25559, -25449, -25338,
+    -25226, -25114, -25001, -24887, -24772, -24657, -24541, -24424, -24306, -24188, -24069, -23950,
+    -23830, -23709, -23587, -23465, -23342, -23218, -23094, -22969, -22843, -22717, -22590, -22463,
+    -22334, -22205, -22076, -21946, -21815, -21684, -21552, -21419, -21286, -21152, -21017, -20882,
+    -20747, -20610, -20473, -20336, -20198, -20059, -19920, -19780, -19640, -19499, -19358, -19216,
+    -19073, -18930, -18786, -18642, -18497, -18352, -18206, -18060, -17913, -17766, -17618, -17469,
+    -17320, -17171, -17021, -16871, -16720, -16569, -16417, -16264, -16112, -15959, -15805, -15651,
+    -15496, -15341, -15186, -15030, -14873, -14717, -14560, -14402, -14244, -14085, -13927, -13767,
+    -13608, -13448, -13287, -13127, -12965, -12804, -12642, -12480, -12317, -12154, -11991, -11827,
+    -11663, -11499, -11334, -11169, -11004, -10838, -10672, -10506, -10339, -10173, -10005, -9838,
+    -9670, -9502, -9334, -9165, -8997, -8828, -8658, -8489, -8319, -8149, -7979, -7808,
+    -7637, -7466, -7295, -7124, -6952, -6780, -6608, -6436, -6264, -6091, -5919, -5746,
+    -5573, -5400, -5226, -5053, -4879, -4705, -4531, -4357, -4183, -4009, -3834, -3660,
+    -3485, -3310, -3136, -2961, -2786, -2611, -2435, -2260, -2085, -1909, -1734, -1559,
+    -1383, -1208, -1032, -856, -681, -505, -329, -154, 22, 198, 373, 549,
+    725, 900,
+};
+
+const int16_t kSampleTable_46875_250[194] = {
+    0, 1098, 2194, 3289, 4379, 5465, 6544, 7616, 8679, 9733, 10776, 11807,
+    12824, 13827, 14815, 15786, 16739, 17673, 18588, 19481, 20353, 21202, 22027, 22828,
+    23602, 24351, 25072, 25764, 26428, 27062, 27666, 28239, 28780, 29289, 29764, 30207,
+    30615, 30989, 31329, 31633, 31901, 32134, 32331, 32491, 32615, 32702, 32753, 32767,
+    32744, 32684, 32588, 32454, 32285, 32079, 31837, 31560, 31247, 30899, 30516, 30099,
+    29648, 29164, 28648, 28099, 27518, 26907, 26265, 25594, 24894, 24166, 23411, 22630,
+    21823, 20992, 20137, 19260, 18361, 17441, 16502, 15545, 14569, 13578, 12571, 11550,
+    10516, 9471, 8414, 7349, 6275, 5194, 4107, 3015, 1920, 823, -275, -1372,
+    -2468, -3562, -4651, -5735, -6813, -7883, -8944, -9995, -11035, -12062, -13076, -14076,
+    -15059, -16026, -16974, -17904, -18813, -19701, -20568, -21411, -22230, -23024, -23792, -24533,
+    -25247, -25933, -26590, -27216, -27812, -28377, -28910, -29411, -29878, -30312, -30712, -31077,
+    -31408, -31703, -31963, -32187, -32374, -32526, -32640, -32718, -32760, -32764, -32732, -32663,
+    -32558, -32415, -32237, -32022, -31771, -31485, -31163, -30807, -30415, -29990, -29531, -29038,
+    -28513, -27956, -27368, -26749, -26100, -25422, -24715, -23980, -23218, -22431, -21618, -20781,
+    -19920, -19037, -18133, -17208, -16264, -15302, -14323, -13328, -12317, -11293, -10256, -9208,
+    -8149, -7081, -6005, -4922, -3834, -2742, -1646, -549, 549, 1646, 2742, 3834,
+    4922, 6005,
+};
+
+const SampleTable kSampleTables[] = {
+    { 46875, 40, kSampleTable_46875_40 },
+    { 46875, 250, kSampleTable_46875_250 },
+};
+
+/**
+ * Q15 sine of 2^kDdsTableBits entries for a full period, for phase
+ * accumulator synthesis. The extra last entry equals the first.
+ */
+constexpr int kDdsTableBits = 10;
+
+const int16_t kDdsSineTable[1025] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2410, 2611, 2811, 3012, 3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6786, 6983,
+    7179, 7375, 7571, 7767, 7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319,
+    9512, 9704, 9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269, 15446, 15623, 15800, 15976,
+    16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000,
+    20159, 20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170, 23311, 23452, 23592,
+    23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674,
+    26790, 26905, 27019, 27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085, 29177,
+    29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050,
+    31113, 31176, 31237, 31297, 31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250,
+    32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752,
+    32757, 32761, 32765, 32766, 32767, 32766, 32765, 32761, 32757, 32752, 32745, 32737,
+    32728, 32717, 32705, 32692, 32678, 32663, 32646, 32628, 32609, 32589, 32567, 32545,
+    32521, 32495, 32469, 32441, 32412, 32382, 32351, 32318, 32285, 32250, 32213, 32176,
+    32137, 32098, 32057, 32014, 31971, 31926, 31880, 31833, 31785, 31736, 31685, 31633,
+    31580, 31526, 31470, 31414, 31356, 31297, 31237, 31176, 31113, 31050, 30985, 30919,
+    30852, 30783, 30714, 30643, 30571, 30498, 30424, 30349, 30273, 30195, 30117, 30037,
+    29956, 29874, 29791, 29706, 29621, 29534, 29447, 29358, 29268, 29177, 29085, 28992,
+    28898, 28803, 28706, 28609, 28510, 28411, 28310, 28208, 28105, 28001, 27896, 27790,
+    27683, 27575, 27466, 27356, 27245, 27133, 27019, 26905, 26790, 26674, 26556, 26438,
+    26319, 26198, 26077, 25955, 25832, 25708, 25582, 25456, 25329, 25201, 25072, 24942,
+    24811, 24680, 24547, 24413, 24279, 24143, 24007, 23870, 23731, 23592, 23452, 23311,
+    23170, 23027, 22884, 22739, 22594, 22448, 22301, 22154, 22005, 21856, 21705, 21554,
+    21403, 21250, 21096, 20942, 20787, 20631, 20475, 20317, 20159, 20000, 19841, 19680,
+    19519, 19357, 19195, 19032, 18868, 18703, 18537, 18371, 18204, 18037, 17869, 17700,
+    17530, 17360, 17189, 17018, 16846, 16673, 16499, 16325, 16151, 15976, 15800, 15623,
+    15446, 15269, 15090, 14912, 14732, 14553, 14372, 14191, 14010, 13828, 13645, 13462,
+    13279, 13094, 12910, 12725, 12539, 12353, 12167, 11980, 11793, 11605, 11417, 11228,
+    11039, 10849, 10659, 10469, 10278, 10087, 9896, 9704, 9512, 9319, 9126, 8933,
+    8739, 8545, 8351, 8157, 7962, 7767, 7571, 7375, 7179, 6983, 6786, 6590,
+    6393, 6195, 5998, 5800, 5602, 5404, 5205, 5007, 4808, 4609, 4410, 4210,
+    4011, 3811, 3612, 3412, 3212, 3012, 2811, 2611, 2410, 2210, 2009, 1809,
+    1608, 1407, 1206, 1005, 804, 603, 402, 201, 0, -201, -402, -603,
+    -804, -1005, -1206, -1407, -1608, -1809, -2009, -2210, -2410, -2611, -2811, -3012,
+    -3212, -3412, -3612, -3811, -4011, -4210, -4410, -4609, -4808, -5007, -5205, -5404,
+    -5602, -5800, -5998, -6195, -6393, -6590, -6786, -6983, -7179, -7375, -7571, -7767,
+    -7962, -8157, -8351, -8545, -8739, -8933, -9126, -9319, -9512, -9704, -9896, -10087,
+    -10278, -10469, -10659, -10849, -11039, -11228, -11417, -11605, -11793, -11980, -12167, -12353,
+    -12539, -12725, -12910, -13094, -13279, -13462, -13645, -13828, -14010, -14191, -14372, -14553,
+    -14732, -14912, -15090, -15269, -15446, -15623, -15800, -15976, -16151, -16325, -16499, -16673,
+    -16846, -17018, -17189, -17360, -17530, -17700, -17869, -18037, -18204, -18371, -18537, -18703,
+    -18868, -19032, -19195, -19357, -19519, -19680, -19841, -20000, -20159, -20317, -20475, -20631,
+    -20787, -20942, -21096, -21250, -21403, -21554, -21705, -21856, -22005, -22154, -22301, -22448,
+    -22594, -22739, -22884, -23027, -23170, -23311, -23452, -23592, -23731, -23870, -24007, -24143,
+    -24279, -24413, -24547, -24680, -24811, -24942, -25072, -25201, -25329, -25456, -25582, -25708,
+    -25832, -25955, -26077, -26198, -26319, -26438, -26556, -26674, -26790, -26905, -27019, -27133,
+    -27245, -27356, -27466, -27575, -27683, -27790, -27896, -28001, -28105, -28208, -28310, -28411,
+    -28510, -28609, -28706, -28803, -28898, -28992, -29085, -29177, -29268, -29358, -29447, -29534,
+    -29621, -29706, -29791, -29874, -29956, -30037, -30117, -30195, -30273, -30349, -30424, -30498,
+    -30571, -30643, -30714, -30783, -30852, -30919, -30985, -31050, -31113, -31176, -31237, -31297,
+    -31356, -31414, -31470, -31526, -31580, -31633, -31685, -31736, -31785, -31833, -31880, -31926,
+    -31971, -32014, -32057, -32098, -32137, -32176, -32213, -32250, -32285, -32318, -32351, -32382,
+    -32412, -32441, -32469, -32495, -32521, -32545, -32567, -32589, -32609, -32628, -32646, -32663,
+    -32678, -32692, -32705, -32717, -32728, -32737, -32745, -32752, -32757, -32761, -32765, -32766,
+    -32767, -32766, -32765, -32761, -32757, -32752, -32745, -32737, -32728, -32717, -32705, -32692,
+    -32678, -32663, -32646, -32628, -32609, -32589, -32567, -32545, -32521, -32495, -32469, -32441,
+    -32412, -32382, -32351, -32318, -32285, -32250, -32213, -32176, -32137, -32098, -32057, -32014,
+    -31971, -31926, -31880, -31833, -31785, -31736, -31685, -31633, -31580, -31526, -31470, -31414,
+    -31356, -31297, -31237, -31176, -31113, -31050, -30985, -30919, -30852, -30783, -30714, -30643,
+    -30571, -30498, -30424, -30349, -30273, -30195, -30117, -30037, -29956, -29874, -29791, -29706,
+    -29621, -29534, -29447, -29358, -29268, -29177, -29085, -28992, -28898, -28803, -28706, -28609,
+    -28510, -28411, -28310, -28208, -28105, -28001, -27896, -27790, -27683, -27575, -27466, -27356,
+    -27245, -27133, -27019, -26905, -26790, -26674, -26556, -26438, -26319, -26198, -26077, -25955,
+    -25832, -25708, -25582, -25456, -25329, -25201, -25072, -24942, -24811, -24680, -24547, -24413,
+    -24279, -24143, -24007, -23870, -23731, -23592, -23452, -23311, -23170, -23027, -22884, -22739,
+    -22594, -22448, -22301, -22154, -22005, -21856, -21705, -21554, -21403, -21250, -21096, -20942,
+    -20787, -20631, -20475, -20317, -20159, -20000, -19841, -19680, -19519, -19357, -19195, -19032,
+    -18868, -18703, -18537, -18371, -18204, -18037, -17869, -17700, -17530, -17360, -17189, -17018,
+    -16846, -16673, -16499, -16325, -16151, -15976, -15800, -15623, -15446, -15269, -15090, -14912,
+    -14732, -14553, -14372, -14191, -14010, -13828, -13645, -13462, -13279, -13094, -12910, -12725,
+    -12539, -12353, -12167, -11980, -11793, -11605, -11417, -11228, -11039, -10849, -10659, -10469,
+    -10278, -10087, -9896, -9704, -9512, -9319, -9126, -8933, -8739, -8545, -8351, -8157,
+    -7962, -7767, -7571, -7375, -7179, -6983, -6786, -6590, -6393, -6195, -5998, -5800,
+    -5602, -5404, -5205, -5007, -4808, -4609, -4410, -4210, -4011, -3811, -3612, -3412,
+    -3212, -3012, -2811, -2611, -2410, -2210, -2009, -1809, -1608, -1407, -1206, -1005,
+    -804, -603, -402, -201, 0,
+};
+
+#endif
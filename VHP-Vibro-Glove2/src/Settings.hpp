@@ -20,9 +20,6 @@ struct Settings {
      */
 
  
-    const uint32_t default_channels = 8;  /* Number of channels silence is played
-					     on when stream is not playing */
-  
     const bool     start_stream_on_power_on = false; /* Start Stream on Power On */
 
 
@@ -42,6 +39,24 @@ struct Settings {
     uint32_t vol_amplitude = 278;
     bool test_mode = false;
     uint16_t single_channel = 0;
+    uint32_t rampduration = 0;
+    uint32_t seed = 0;  /* Seed of the channel order and jitter, 0
+			   takes a new seed at every start */
+    uint8_t group_count = 0;  /* Number of tactors in groups, when it
+				 equals the tactors of the tactor map
+				 tactor t plays stream channel
+				 groups[t], otherwise chan8 selects
+				 the groups, see ChannelMap.hpp */
+    uint8_t groups[12] = { 0 };
+
+    /**
+     * @return true if a stream can be built from the settings: SStream
+     * divides by stimfreq, cycleperiod and pauzecycleperiod, and needs
+     * at least 2 samples per period of stimfreq
+     */
+    bool valid() const {
+	return stimfreq > 0 && stimfreq <= samplerate / 2 && cycleperiod > 0 && pauzecycleperiod > 0;
+    }
   
 } g_settings;
 
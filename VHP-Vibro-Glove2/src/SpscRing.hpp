@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <atomic>
+
+#ifndef SPSCRING_HPP_
+#define SPSCRING_HPP_
+
+/**
+ * SpscRing - lock-free single producer, single consumer ring of T
+ *
+ * Entries are filled and read in place, so no copies of T are made:
+ *
+ *   producer: T* e = ring.back();  if(e) { fill(*e); ring.push(); }
+ *   consumer: T* e = ring.front(); if(e) { use(*e);  ring.pop(); }
+ *
+ * The producer only writes head_, the consumer only writes tail_, so
+ * both sides may run in different contexts (thread and interrupt)
+ * without locking.
+ *
+ * @param kCapacity - number of entries, must be a power of two
+ */
+template<typename T, uint32_t kCapacity>
+class SpscRing {
+    static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+		  "SpscRing capacity must be a power of two");
+public:
+    SpscRing() : head_(0), tail_(0) {}
+
+    /**
+     * @return entry to fill, or nullptr when the ring is full
+     * (producer)
+     */
+    T* back() {
+	const uint32_t head = head_.load(std::memory_order_relaxed);
+	if(head - tail_.load(std::memory_order_acquire) == kCapacity)
+	    return nullptr;
+	return &entries_[head & kMask];
+    }
+
+    /**
+     * Publishes the entry returned by back() (producer)
+     */
+    void push() {
+	head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @return oldest entry, or nullptr when the ring is empty
+     * (consumer)
+     */
+    const T* front() const {
+	const uint32_t tail = tail_.load(std::memory_order_relaxed);
+	if(head_.load(std::memory_order_acquire) == tail)
+	    return nullptr;
+	return &entries_[tail & kMask];
+    }
+
+    /**
+     * Releases the entry returned by front() (consumer)
+     */
+    void pop() {
+	tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @return number of entries ready for the consumer
+     */
+    uint32_t size() const {
+	return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    constexpr static uint32_t capacity() { return kCapacity; }
+    
+private:
+    constexpr static uint32_t kMask = kCapacity - 1;
+    
+    // free running counters, wrap around is harmless as kCapacity
+    // divides 2^32
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+    T entries_[kCapacity];
+};
+
+#endif
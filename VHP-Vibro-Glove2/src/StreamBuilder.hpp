@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <algorithm>
+#include <new>
+
+#include "SStream.hpp"
+#include "Settings.hpp"
+#include "TactorMap.hpp"
+
+#ifndef STREAMBUILDER_HPP_
+#define STREAMBUILDER_HPP_
+
+/**
+ * StreamBuilder - builds the SStream of the settings, as
+ * PrepareStream() in VHP-Vibro-Glove2.ino does
+ *
+ * Kept out of the sketch so the constructor call, the one place all
+ * settings meet the stream, is compiled and tested on the host.
+ */
+struct StreamBuilder {
+    /**
+     * @return the tactors of the tactor map with the stream channel
+     * each one plays: the uploaded groups if they are for this number
+     * of tactors, otherwise independent or mirrored as chan8
+     */
+    static ChannelMap channel_map(const Settings& settings, const TactorMap& tactor_map) {
+	uint8_t group[TactorMap::kMaxTactors];
+	if(settings.group_count == tactor_map.tactors)
+	    std::copy(settings.groups, settings.groups + settings.group_count, group);
+	else
+	    ChannelMap::mirror_groups(group, tactor_map.tactors, settings.chan8);
+	return ChannelMap(tactor_map.order, group, tactor_map.tactors);
+    }
+
+    /**
+     * build() - constructs the stream in storage
+     *
+     * @param storage - sizeof(SStream) bytes aligned as SStream
+     * @param volume - PWM level of the volume, see VolumeLevel()
+     * @param waveform - active waveform, nullptr plays the sine
+     * @param waveform_size - samples in waveform
+     * @param slot_gains - gain of every PWM slot, see Calibration.hpp
+     * @param pattern - active pattern, nullptr plays the bursts
+     * @param pattern_size - bytes in pattern
+     * @return the stream, placed in storage
+     */
+    static SStream* build(void* storage, const Settings& settings, const TactorMap& tactor_map,
+			  uint32_t volume, const int16_t* waveform, uint32_t waveform_size,
+			  const uint16_t* slot_gains, const uint8_t* pattern, uint32_t pattern_size) {
+	return new (storage) SStream(channel_map(settings, tactor_map),
+				     settings.samplerate,
+				     settings.stimfreq,
+				     settings.stimduration,
+				     settings.cycleperiod,
+				     settings.pauzecycleperiod,
+				     settings.pauzedcycles,
+				     settings.jitter,
+				     volume,
+				     settings.test_mode,
+				     settings.single_channel,
+				     settings.rampduration,
+				     waveform,
+				     waveform_size,
+				     slot_gains,
+				     pattern,
+				     pattern_size);
+    }
+};
+
+#endif
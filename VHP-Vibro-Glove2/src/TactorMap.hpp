@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "BoardDefs.hpp"
+
+#ifndef TACTORMAP_HPP_
+#define TACTORMAP_HPP_
+
+/**
+ * TactorMap - number of tactors and the PWM slot (module * 4 +
+ * channel) each one is wired to, so a rewired glove is remapped
+ * without reflashing
+ *
+ * Tactor t is connected to PWM slot order[t], the stream channel
+ * driving it is set by the ChannelMap. The default is the 8 tactors
+ * of order_pairs in BoardDefs.hpp, a map uploaded over BLE replaces
+ * it and is persisted in flash. Up to all 12 slots can have a tactor.
+ */
+struct TactorMap {
+    enum {
+	kMaxTactors = audio_tactile::kNumTotalPwm,
+	kNumSlots = audio_tactile::kNumTotalPwm
+    };
+
+    TactorMap() : tactors(sizeof(order_pairs) / sizeof(order_pairs[0])), order{0} {
+	std::copy(order_pairs, order_pairs + tactors, order);
+    }
+
+    /**
+     * @param slots - PWM slot of every tactor, in tactor order
+     * @param count - number of tactors, 1 .. kMaxTactors
+     * @return false if count or a slot is out of range or a slot is
+     * used twice, the map is then left as it is
+     */
+    bool set(const uint8_t* slots, uint32_t count) {
+	if(count == 0 || count > kMaxTactors)
+	    return false;
+	bool used[kNumSlots] = { false };
+	for(uint32_t tactor = 0; tactor < count; tactor++) {
+	    if(slots[tactor] >= kNumSlots || used[slots[tactor]])
+		return false;
+	    used[slots[tactor]] = true;
+	}
+	tactors = count;
+	std::fill(order, order + kMaxTactors, 0);
+	std::copy(slots, slots + count, order);
+	return true;
+    }
+
+    /**
+     * @return true if a tactor is wired to slot
+     */
+    bool drives(uint32_t slot) const {
+	return std::find(order, order + tactors, slot) != order + tactors;
+    }
+
+    uint32_t tactors;
+    // PWM slot of each tactor, as order_pairs
+    uint16_t order[kMaxTactors];
+};
+
+#endif
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <array>
+
+#include "att/Serialize.hpp"
+
+#ifndef WAVEFORMUPLOAD_HPP_
+#define WAVEFORMUPLOAD_HPP_
+
+/**
+ * WaveformUpload - user defined waveform, received in chunks over BLE
+ *
+ * The waveform is a single period of up to kMaxSamples Q15 samples
+ * (int16, 32767 ~ 1.0), played in place of the sine. It is written
+ * chunk by chunk into the back buffer, commit() checks the Fletcher16
+ * of the whole waveform and makes it the active one. A failed or
+ * partial upload leaves the active waveform as it is.
+ *
+ * SampleCache resamples the active waveform into its table when a
+ * stream is built, so playing it costs the same as the sine.
+ */
+class WaveformUpload {
+public:
+    enum {
+	kMaxSamples = 1024
+    };
+
+    WaveformUpload() : active_(0), size_{0, 0} {}
+
+    /**
+     * Writes samples to the back buffer
+     *
+     * @param offset - index of the first sample
+     * @param data - little endian int16 samples
+     * @param bytes - size of data, an even number
+     * @return false if the chunk does not fit
+     */
+    bool write_chunk(uint32_t offset, const uint8_t* data, uint32_t bytes) {
+	const uint32_t samples = bytes / 2;
+	if(bytes % 2 || offset + samples > kMaxSamples)
+	    return false;
+
+	auto& back = buffer_[active_ ^ 1];
+	for(uint32_t i = 0; i < samples; i++)
+	    back[offset + i] = ::LittleEndianReadS16(data + 2 * i);
+	return true;
+    }
+
+    /**
+     * Makes the first `samples` of the back buffer the active waveform,
+     * if they match checksum. 0 samples returns to the sine.
+     *
+     * @param checksum - Fletcher16, init 1, of the waveform as little
+     *        endian int16
+     * @return false if the checksum or size is invalid
+     */
+    bool commit(uint32_t samples, uint16_t checksum) {
+	if(samples > kMaxSamples)
+	    return false;
+
+	const uint32_t back = active_ ^ 1;
+	if(samples > 0 && checksum != calc_checksum(buffer_[back].data(), samples))
+	    return false;
+
+	size_[back] = samples;
+	active_ = back;
+	return true;
+    }
+
+    /**
+     * The active waveform and its number of samples
+     */
+    struct Active {
+	const int16_t* samples;  // nullptr for the sine
+	uint32_t size;           // 0 for the sine
+    };
+
+    /**
+     * @return the active waveform with its size, from one read of the
+     * active buffer, so a commit() in between cannot pair the samples
+     * of one buffer with the size of the other
+     */
+    Active active() const {
+	const uint32_t active = active_;
+	return Active{ size_[active] ? buffer_[active].data() : nullptr, size_[active] };
+    }
+
+    /**
+     * @return the active waveform, nullptr for the sine
+     */
+    const int16_t* samples() const { return active().samples; }
+
+    /**
+     * @return number of samples of the active waveform, 0 for the sine
+     */
+    uint32_t size() const { return active().size; }
+
+    static uint16_t calc_checksum(const int16_t* samples, uint32_t size) {
+	uint16_t checksum = 1;
+	for(uint32_t i = 0; i < size; i++) {
+	    uint8_t bytes[2];
+	    ::LittleEndianWriteU16((uint16_t) samples[i], bytes);
+	    checksum = ::Fletcher16(bytes, 2, checksum);
+	}
+	return checksum;
+    }
+    
+private:
+    volatile uint32_t active_;
+    // volatile, so the size is stored before active_ switches to it
+    volatile uint32_t size_[2];
+    std::array<std::array<int16_t, kMaxSamples>, 2> buffer_;
+};
+
+#endif
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the per tactor gains of Calibration.hpp in SStream::render():
+ *
+ * - a tactor's gain scales its PWM slot around the silence level,
+ *   other slots are untouched
+ * - in mirrored mode (chan8 == false) both tactors of a channel get
+ *   their own gain
+ * - unity gains give the uncalibrated output
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint16_t volume = 200;
+
+/*
+ * Renders `sequences` PWM sequences of all modules
+ */
+vector<uint16_t> render(bool chan8, const Calibration* calibration, uint32_t sequences)
+{
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(chan8), 46875, 250, 100, chan8 ? 1332 : 666, 5, 2, 235, volume, false, 0, 0,
+	       nullptr, 0, calibration ? calibration->slot_gain : nullptr);
+    return render_sequences(ss, sequences);
+}
+
+int main() 
+{
+    const uint32_t sequences = 46875 * 4 / (kFrames * SStream::samples_per_frame());
+    
+    Calibration unity;
+    CHECK(!unity.set_tactor_gain(8, 100));
+    CHECK(!unity.set_tactor_gain(0, Calibration::kUnityGain + 1));
+
+    for(bool chan8 : { true, false }) {
+	const auto reference = render(chan8, nullptr, sequences);
+	CHECK(render(chan8, &unity, sequences) == reference);
+	
+	Calibration calibration;
+	CHECK(calibration.set_tactor_gain(1, Calibration::kUnityGain / 2));
+	CHECK(calibration.set_tactor_gain(6, Calibration::kUnityGain / 4));
+	CHECK(calibration.tactor_gain(1) == Calibration::kUnityGain / 2);
+	const auto out = render(chan8, &calibration, sequences);
+
+	uint32_t scaled = 0;
+	for(uint32_t i = 0; i < out.size(); i++) {
+	    const int32_t gain = calibration.slot_gain[slot_of(i)];
+	    const int32_t expected = volume + ((reference[i] - volume) * gain >> 15);
+	    if(out[i] != expected) {
+		cout << "FAIL chan8 " << chan8 << " sample " << i << " slot " << slot_of(i)
+		     << ": " << out[i] << " expected " << expected << endl;
+		return 1;
+	    }
+	    scaled += out[i] != reference[i];
+	}
+	cout << "chan8 " << chan8 << ": " << scaled << " samples scaled" << endl;
+	CHECK(scaled > 0);
+    }
+
+    cout << "PASS" << endl;
+    return 0;
+}
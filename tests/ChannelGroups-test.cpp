@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the N channel topology of ChannelMap.hpp:
+ *
+ * - the group table of 8 tactors reproduces the chan8 mapping
+ * - valid_groups() rejects channels out of range and gaps
+ * - 12 tactors in 6 mirror groups play every pair identically
+ * - 10 independent tactors play one at a time, the 2 free slots are
+ *   not written
+ * - in mirrored mode every cycle plays all 4 channels
+ * - a pattern plays channels 8..11 from the high channel mask
+ * - for every number of channels and a range of cycle periods, each
+ *   frame plays the slot it falls in, the frames after the last whole
+ *   slot play the last one
+ */
+
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint16_t volume = 200;
+// written to the buffer before rendering, no PWM level
+const uint16_t kMarker = 0xBEEF;
+
+/*
+ * Renders `sequences` PWM sequences of all modules into a buffer
+ * holding kMarker
+ */
+vector<uint16_t> render(const ChannelMap& map, uint32_t sequences, const vector<uint8_t>& pattern = {})
+{
+    SStream ss(map, 46875, 250, 100, 1332, 5, 2, 235, volume, false, 0, 0,
+	       nullptr, 0, nullptr, pattern.empty() ? nullptr : pattern.data(), pattern.size());
+    ss.reset(1);
+    return render_sequences(ss, sequences, kMarker);
+}
+
+/*
+ * @return true if any of the first `count` samples is not silence
+ */
+bool plays(const vector<uint16_t>& samples, size_t count)
+{
+    return any_of(samples.begin(), samples.begin() + min(count, samples.size()),
+		  [](uint16_t s) { return s != volume; });
+}
+
+/*
+ * @return true if every frame of 2 cycles in test mode plays the
+ * channel of its slot
+ */
+bool plays_slots(uint32_t channels, uint32_t cycleperiod)
+{
+    uint16_t slots[ChannelMap::kNumSlots];
+    iota(slots, slots + ChannelMap::kNumSlots, 0);
+    uint8_t group[ChannelMap::kNumSlots];
+    ChannelMap::mirror_groups(group, channels, true);
+    SStream ss(ChannelMap(slots, group, channels), 46875, 250, 100, cycleperiod, 1, 0, 0, volume, true);
+    ss.reset(1);
+
+    const uint32_t samples_per_cycle = 46875 * cycleperiod / 1000;
+    const uint32_t frames_per_cycle = samples_per_cycle / SStream::samples_per_frame();
+    const uint32_t samples_per_slot = samples_per_cycle / channels;
+    // the first frame played is frame 1
+    for(uint32_t n = 1; n <= 2 * frames_per_cycle; n++) {
+	ss.next_sample_frame();
+	const uint32_t frame = n % frames_per_cycle;
+	const uint32_t slot = samples_per_slot ? frame * SStream::samples_per_frame() / samples_per_slot : channels;
+	if(ss.current_active_channel() != min(slot, channels - 1)) {
+	    cout << channels << " channels, cycleperiod " << cycleperiod << ": frame " << frame
+		 << " plays " << ss.current_active_channel() << endl;
+	    return false;
+	}
+    }
+    return true;
+}
+
+int main()
+{
+    // 2 s of sequences, the first cycle of 1332 ms is 62437 samples
+    const uint32_t sequences = 46875 * 2 / (kFrames * SStream::samples_per_frame());
+    const uint32_t cycle_samples = 46875 * 1332 / 1000;
+
+    uint16_t slots[ChannelMap::kNumSlots];
+    iota(slots, slots + ChannelMap::kNumSlots, 0);
+    uint8_t group[ChannelMap::kNumSlots];
+
+    // the legacy mapping is the group table of 8 tactors
+    for(bool chan8 : { true, false }) {
+	ChannelMap::mirror_groups(group, 8, chan8);
+	const ChannelMap groups(order_pairs, group, 8);
+	const ChannelMap legacy(order_pairs, chan8);
+	CHECK(groups.channels() == (chan8 ? 8u : 4u) && legacy.channels() == groups.channels());
+	for(uint32_t slot = 0; slot < ChannelMap::kNumSlots; slot++)
+	    CHECK(groups.source(slot / 4, slot % 4) == legacy.source(slot / 4, slot % 4));
+    }
+
+    const uint8_t gap[] = { 0, 2, 2, 0 };
+    const uint8_t out_of_range[] = { 0, 12 };
+    CHECK(ChannelMap::valid_groups(group, 8));
+    CHECK(!ChannelMap::valid_groups(gap, 4) && !ChannelMap::valid_groups(out_of_range, 2));
+    CHECK(!ChannelMap::valid_groups(group, 0) && !ChannelMap::valid_groups(group, 13));
+
+    // 12 tactors, tactor 11 - t mirrors tactor t
+    ChannelMap::mirror_groups(group, 12, false);
+    CHECK(ChannelMap::valid_groups(group, 12) && group[6] == 5 && group[11] == 0);
+    const ChannelMap twelve(slots, group, 12);
+    CHECK(twelve.channels() == 6);
+    auto out = render(twelve, sequences);
+    for(uint32_t t = 0; t < 6; t++) {
+	const auto samples = slot_samples(out, t);
+	CHECK(plays(samples, cycle_samples));
+	CHECK(samples == slot_samples(out, 11 - t));
+    }
+
+    // 10 independent tactors, one playing at a time
+    ChannelMap::mirror_groups(group, 10, true);
+    const ChannelMap ten(slots, group, 10);
+    CHECK(ten.channels() == 10);
+    out = render(ten, sequences);
+    vector<vector<uint16_t>> samples;
+    for(uint32_t slot = 0; slot < ChannelMap::kNumSlots; slot++)
+	samples.push_back(slot_samples(out, slot));
+    for(uint32_t t = 0; t < 10; t++)
+	CHECK(plays(samples[t], cycle_samples));
+    CHECK(samples[10] == vector<uint16_t>(samples[10].size(), kMarker));
+    CHECK(samples[11] == vector<uint16_t>(samples[11].size(), kMarker));
+    for(uint32_t i = 0; i < samples[0].size(); i++) {
+	uint32_t playing = 0;
+	for(uint32_t t = 0; t < 10; t++)
+	    playing += samples[t][i] != volume;
+	CHECK(playing <= 1);
+    }
+
+    // mirrored 8 tactors schedule the 4 channels that drive them
+    out = render(ChannelMap(false), sequences);
+    for(uint32_t t = 0; t < 8; t++)
+	CHECK(plays(slot_samples(out, order_pairs[t]), cycle_samples));
+
+    // channel 0 and channel 9, then channel 11 alone
+    const vector<uint8_t> pattern = {
+	Pattern::kVersion, 2, 100, 0,
+	0x01, 255, Pattern::kSine, 0x02, 0, 0, 40, 0,
+	0x00, 255, Pattern::kSine, 0x08, 50, 0, 40, 0,
+    };
+    CHECK(Pattern::valid(pattern.data(), pattern.size()));
+    auto reserved = pattern;
+    reserved[Pattern::kHeaderSize + 3] = 0x10;
+    CHECK(!Pattern::valid(reserved.data(), reserved.size()));
+    auto none = pattern;
+    none[Pattern::kHeaderSize + 3] = none[Pattern::kHeaderSize] = 0;
+    CHECK(!Pattern::valid(none.data(), none.size()));
+
+    ChannelMap::mirror_groups(group, 12, true);
+    out = render(ChannelMap(slots, group, 12), sequences, pattern);
+    const uint32_t half_period = 46875 / 20;
+    for(uint32_t slot = 0; slot < ChannelMap::kNumSlots; slot++) {
+	const auto s = slot_samples(out, slot);
+	const bool first = plays(s, half_period);
+	const bool second = plays(vector<uint16_t>(s.begin() + half_period, s.end()), half_period);
+	CHECK(first == (slot == 0 || slot == 9));
+	CHECK(second == (slot == 11));
+    }
+
+    for(uint32_t channels = 1; channels <= ChannelMap::kMaxChannels; channels++) {
+	for(uint32_t cycleperiod = 1; cycleperiod <= 400; cycleperiod++)
+	    CHECK(plays_slots(channels, cycleperiod));
+	for(uint32_t cycleperiod : { 666, 1332, 2999, 3000, 4999 })
+	    CHECK(plays_slots(channels, cycleperiod));
+    }
+
+    cout << "PASS" << endl;
+    return 0;
+}
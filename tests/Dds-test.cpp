@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Measures the played stimulation frequency of SStream for the
+ * synthesis method selected with VHP_DDS, from the upward mean
+ * crossings of one second of a single channel.
+ *
+ * - VHP_DDS=0 plays samplerate / (samplerate / stimfreq), the error
+ *   is reported and checked against that
+ * - VHP_DDS=1, 2 must play stimfreq within 0.01%, and stay close to
+ *   an ideal sine
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+const uint32_t samplerate = 46875;
+const uint16_t volume = 2000;
+
+/*
+ * One slot of a second of channel 0, which plays for the full slot
+ */
+vector<uint16_t> render_tone(uint32_t stimfreq)
+{
+    SStream ss(ChannelMap(false), samplerate, stimfreq, 1000, 4000, 1, 0, 0, volume, true, 1);
+    vector<uint16_t> out;
+    uint16_t frame[SStream::samples_per_frame() * SStream::kChannelsPerModule];
+    
+    while(out.size() < samplerate - SStream::samples_per_frame()) {
+	ss.next_sample_frame();
+	ss.set_chan_samples(frame, 0);
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+	    out.push_back(frame[i * SStream::kChannelsPerModule]);
+    }
+    return out;
+}
+
+/*
+ * @return frequency from a least squares fit of the interpolated
+ * upward crossings of volume
+ */
+double measure_frequency(const vector<uint16_t>& samples)
+{
+    vector<double> crossings;
+    for(size_t i = 1; i < samples.size(); i++)
+	if(samples[i - 1] < volume && samples[i] >= volume)
+	    crossings.push_back(i - 1 + double(volume - samples[i - 1]) / (samples[i] - samples[i - 1]));
+
+    const double n = crossings.size();
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for(size_t k = 0; k < crossings.size(); k++) {
+	sx += k;
+	sy += crossings[k];
+	sxx += double(k) * k;
+	sxy += k * crossings[k];
+    }
+    const double period = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    return samplerate / period;
+}
+
+/*
+ * @return largest difference with the ideal sine of stimfreq, in PWM
+ * levels. The first sample is sample 8 of the slot.
+ */
+double max_error(const vector<uint16_t>& samples, uint32_t stimfreq)
+{
+    double error = 0;
+    for(size_t i = 0; i < samples.size(); i++) {
+	const double ideal = volume + volume * sin(2 * M_PI * stimfreq * (i + SStream::samples_per_frame()) / samplerate);
+	error = max(error, fabs(samples[i] - ideal));
+    }
+    return error;
+}
+
+int main() 
+{
+    bool ok = true;
+
+    cout << "VHP_DDS=" << VHP_DDS << endl;
+    for(uint32_t stimfreq : { 40, 77, 250 }) {
+	const auto samples = render_tone(stimfreq);
+	const double played = measure_frequency(samples);
+	const double error = (played - stimfreq) / stimfreq;
+
+	cout << stimfreq << " Hz: played " << played << " Hz, error " << error * 100 << "%";
+	if(kSynthesis == 0) {
+	    const double expected = double(samplerate) / (samplerate / stimfreq);
+	    ok &= fabs(played - expected) / expected < 1e-4;
+	} else {
+	    const double amplitude_error = max_error(samples, stimfreq);
+	    cout << ", max error " << amplitude_error << " levels";
+	    ok &= fabs(error) < 1e-4;
+	    // nearest entry: half an entry, pi / 1024 of volume, plus rounding
+	    ok &= amplitude_error < (kSynthesis == 1 ? volume * M_PI / (1 << kDdsTableBits) + 2 : 3);
+	}
+	cout << endl;
+    }
+    
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
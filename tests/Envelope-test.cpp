@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the attack and release envelope of SStream, by comparing a
+ * stream with a ramp to the same stream without one:
+ *
+ * - outside the ramps the output is identical
+ * - in the ramps the amplitude is never larger and rises resp. falls
+ * - the first and last sample of a stimulation are close to silence
+ * - a ramp much longer than its gain table still rises from silence
+ *   to full amplitude without steps back
+ */
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t samplerate = 46875;
+const uint16_t volume = 2000;
+const uint32_t stimduration = 200;
+const uint32_t rampduration = 20;
+
+/*
+ * One cycle of channel 0, which plays in every slot
+ */
+vector<uint16_t> render_cycle(uint32_t ramp)
+{
+    SStream ss(ChannelMap(false), samplerate, 250, stimduration, 4000, 1, 0, 0, volume, true, 1, ramp);
+    vector<uint16_t> out;
+    uint16_t frame[SStream::samples_per_frame() * SStream::kChannelsPerModule];
+    
+    while(out.size() < 4 * samplerate) {
+	ss.next_sample_frame();
+	ss.set_chan_samples(frame, 0);
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+	    out.push_back(frame[i * SStream::kChannelsPerModule]);
+    }
+    return out;
+}
+
+/*
+ * The half second ramp of a stimulation of a second, on a full scale
+ * deviation from volume
+ */
+bool check_long_ramp()
+{
+    const uint32_t ramp = samplerate / 2;
+    const Envelope envelope(ramp);
+    CHECK(envelope.samples() == ramp);
+
+    int prev = -1;
+    for(uint32_t n = 0; n < ramp; n++) {
+	const int deviation = envelope.apply(2 * volume, volume, n) - volume;
+	CHECK(deviation >= prev);
+	prev = deviation;
+    }
+    CHECK(envelope.apply(2 * volume, volume, 0) - volume <= 1);
+    CHECK(prev >= volume - 1);
+    CHECK(envelope.apply(2 * volume, volume, ramp) == 2 * volume);
+    return true;
+}
+
+int main() 
+{
+    const auto hard = render_cycle(0);
+    const auto ramped = render_cycle(rampduration);
+    const uint32_t ramp = rampduration * samplerate / 1000;
+    const uint32_t period = samplerate / 250;
+    CHECK(hard.size() == ramped.size());
+
+    // stimulations of the second slot, the first one starts in the
+    // frame before the first rendered one
+    uint32_t first = 0;
+    while(hard[first] == volume || first < samplerate / 2)
+	first++;
+    uint32_t last = first;
+    while(hard[last + 1] != volume || hard[last + 2] != volume)
+	last++;
+    cout << "stimulation " << first << " .. " << last << ", ramp " << ramp << " samples" << endl;
+    CHECK(last - first > 2 * ramp);
+    
+    uint32_t differ = 0;
+    for(uint32_t i = first; i <= last; i++) {
+	const int h = abs(hard[i] - volume);
+	const int r = abs(ramped[i] - volume);
+	if(i >= first + ramp && i <= last - ramp)
+	    CHECK(hard[i] == ramped[i]);
+	CHECK(r <= h);
+	differ += r != h;
+    }
+    cout << differ << " samples attenuated" << endl;
+    CHECK(differ > ramp);
+
+    // peak amplitude per stimulation period through the ramps
+    int prev_attack = -1, prev_release = -1;
+    for(uint32_t p = 0; p + period <= ramp; p += period) {
+	int attack = 0, release = 0;
+	for(uint32_t i = 0; i < period; i++) {
+	    attack = max(attack, abs(ramped[first + p + i] - volume));
+	    release = max(release, abs(ramped[last - p - i] - volume));
+	}
+	CHECK(attack >= prev_attack);
+	CHECK(release >= prev_release);
+	prev_attack = attack;
+	prev_release = release;
+    }
+
+    cout << "edges: hard " << hard[first] - volume << " / " << hard[last] - volume
+	 << ", ramped " << ramped[first] - volume << " / " << ramped[last] - volume << endl;
+    CHECK(abs(ramped[first] - volume) <= 1);
+    CHECK(abs(ramped[last] - volume) <= 1);
+    
+    CHECK(check_long_ramp());
+
+    cout << "PASS" << endl;
+    return 0;
+}
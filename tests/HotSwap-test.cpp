@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the hand-over of SStream::render(buffers, frames, next):
+ *
+ * - the frames up to the end of the cycle are those of the playing
+ *   stream, also when the cycle ends within a block of frames
+ * - from the next frame on, next plays the cycle after the current
+ *   one, pauze cycles included, as a stream started with next's
+ *   settings plays that cycle
+ * - next keeps the seed of the playing stream
+ * - a pattern takes over at the end of the cycle, and a stream from
+ *   a pattern at the end of its period
+ * - render_module() hands over as render()
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t samplerate = 46875;
+const uint16_t volume = 200;
+
+// test mode and no jitter, so every cycle that is not pauzed plays
+// the same. 1332 ms is 7804 frames, 666 ms 3902.
+SStream make_stream(uint32_t stimfreq, uint32_t cycleperiod, bool test_mode = true,
+		    const vector<uint8_t>& pattern = {})
+{
+    return SStream(ChannelMap(true), samplerate, stimfreq, 100, cycleperiod, 5, 2, test_mode ? 0 : 235, volume,
+		   test_mode, 0, 0, nullptr, 0, nullptr,
+		   pattern.empty() ? nullptr : pattern.data(), pattern.size());
+}
+
+uint32_t frames_per_cycle(uint32_t cycleperiod)
+{
+    return samplerate * cycleperiod / 1000 / SStream::samples_per_frame();
+}
+
+/*
+ * Rendered frames in the order they are played, the samples of
+ * frame f of all modules at [f]
+ */
+typedef vector<vector<uint16_t>> Frames;
+
+void append(Frames& out, const vector<uint16_t>& buffer)
+{
+    for(uint32_t f = 0; f < kFrames; f++) {
+	vector<uint16_t> frame;
+	for(uint32_t m = 0; m < ChannelMap::kNumModules; m++) {
+	    const uint16_t* src = &buffer[(m * kFrames + f) * kFrameSamples];
+	    frame.insert(frame.end(), src, src + kFrameSamples);
+	}
+	out.push_back(frame);
+    }
+}
+
+Frames render(SStream& stream, uint32_t blocks)
+{
+    Frames out;
+    vector<uint16_t> buffer(kSequenceSamples);
+    for(uint32_t n = 0; n < blocks; n++) {
+	stream.render(buffer.data(), kFrames);
+	append(out, buffer);
+    }
+    return out;
+}
+
+/*
+ * @return true if all tactors are silent in frame, slots without a
+ * tactor are not written by the stream
+ */
+bool silent(const vector<uint16_t>& frame)
+{
+    for(auto slot : order_pairs)
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+	    if(frame[slot / 4 * kFrameSamples + i * 4 + slot % 4] != volume)
+		return false;
+    return true;
+}
+
+/*
+ * Plays `blocks` blocks of kFrames, a alone for the first `alone`
+ * blocks and then offering b, and checks that the frames before
+ * `handover` are a's and the frames from it on are b's, b playing as
+ * the reference stream b_ref from frame b_first on. b has to keep
+ * a's seed.
+ */
+bool check_handover(SStream a, SStream b, SStream a_ref, SStream b_ref,
+		    uint32_t alone, uint32_t blocks, uint32_t handover, uint32_t b_first)
+{
+    a.reset(1); a_ref.reset(1); b.reset(2); b_ref.reset(2);
+
+    Frames out;
+    vector<uint16_t> buffer(kSequenceSamples);
+    SStream* playing = &a;
+    for(uint32_t n = 0; n < blocks; n++) {
+	SStream* next = playing->render(buffer.data(), kFrames, n < alone ? nullptr : &b);
+	append(out, buffer);
+	// the block with the boundary hands over
+	CHECK((next == &b) == (n >= handover / kFrames));
+	playing = next;
+    }
+    CHECK(b.seed() == 1);
+
+    const Frames a_expected = render(a_ref, blocks);
+    const Frames b_expected = render(b_ref, (b_first + out.size()) / kFrames + 1);
+    for(uint32_t f = 0; f < out.size(); f++) {
+	if(f < handover) {
+	    CHECK(out[f] == a_expected[f]);
+	} else {
+	    CHECK(out[f] == b_expected[b_first + f - handover]);
+	}
+    }
+    return true;
+}
+
+/*
+ * A fresh stream renders frame 1 of cycle 0 first, so cycle c starts
+ * at frame c * frames_per_cycle - 1
+ */
+uint32_t cycle_start(uint32_t cycle, uint32_t cycleperiod)
+{
+    return cycle * frames_per_cycle(cycleperiod) - 1;
+}
+
+bool check_cycle_handover()
+{
+    const SStream a = make_stream(250, 1332), b = make_stream(40, 666);
+
+    // b plays cycle 1 from the end of a's cycle 0, which ends within a
+    // block, as a stream with b's settings plays its cycle 1
+    CHECK(cycle_start(1, 1332) % kFrames != 0);
+    CHECK(check_handover(a, b, a, b, 0, cycle_start(1, 1332) / kFrames + 3 * frames_per_cycle(666) / kFrames,
+			 cycle_start(1, 1332), cycle_start(1, 666)));
+
+    // a plays cycles 0 to 2, b continues with the pauzed cycles 3 and
+    // 4 and cycle 0 of the next pauze period
+    const uint32_t alone = cycle_start(2, 1332) / kFrames + 1;
+    const uint32_t blocks = cycle_start(3, 1332) / kFrames + 3 * frames_per_cycle(666) / kFrames;
+    CHECK(check_handover(a, b, a, b, alone, blocks, cycle_start(3, 1332), cycle_start(3, 666)));
+
+    // which is silent for two cycles
+    SStream a_run = a, b_run = b;
+    a_run.reset(1);
+    vector<uint16_t> buffer(kSequenceSamples);
+    SStream* playing = &a_run;
+    Frames out;
+    for(uint32_t n = 0; n < blocks; n++) {
+	playing = playing->render(buffer.data(), kFrames, n < alone ? nullptr : &b_run);
+	append(out, buffer);
+    }
+    uint32_t sounding = 0;
+    for(uint32_t f = cycle_start(3, 1332); f < cycle_start(3, 1332) + 2 * frames_per_cycle(666); f++)
+	sounding += !silent(out[f]);
+    CHECK(sounding == 0);
+    for(uint32_t f = cycle_start(3, 1332) + 2 * frames_per_cycle(666); f < out.size(); f++)
+	sounding += !silent(out[f]);
+    CHECK(sounding > 0);
+    return true;
+}
+
+vector<uint8_t> encode_pattern(uint16_t period)
+{
+    // channel 1 from 0 ms for 50 ms, channel 2 from 50 ms for 50 ms
+    return { 1, 2, (uint8_t) period, (uint8_t) (period >> 8),
+	     0x01, 255, 0, 0, 0, 0, 50, 0,
+	     0x02, 255, 0, 0, 50, 0, 50, 0 };
+}
+
+bool check_pattern_handover()
+{
+    const auto pattern = encode_pattern(100);
+    const uint32_t pattern_frames = (100 * samplerate / 1000 + 4) / 8;
+    const SStream a = make_stream(250, 666);
+    const SStream p = make_stream(250, 666, true, pattern);
+
+    // the pattern starts with its first frame, as a fresh pattern
+    // stream does
+    CHECK(check_handover(a, p, a, p, 0, cycle_start(1, 666) / kFrames + 2 * pattern_frames / kFrames,
+			 cycle_start(1, 666), 0));
+
+    // a stream takes over at the end of the period, with cycle 1
+    CHECK(check_handover(p, a, p, a, 2, 3 * pattern_frames / kFrames, pattern_frames, cycle_start(1, 666)));
+    return true;
+}
+
+bool check_render_module()
+{
+    // the stream is shared by the modules, as in OnPwmSequenceEnd()
+    // without VHP_PWM_SYNC
+    SStream a = make_stream(250, 666), b = make_stream(40, 666);
+    a.reset(1); b.reset(1);
+    const uint32_t module_samples = kFrames * kFrameSamples;
+    vector<uint16_t> buffer(module_samples);
+
+    SStream* playing = &a;
+    uint32_t rendered = 0;
+    while(playing == &a && rendered < 2 * frames_per_cycle(666)) {
+	playing = playing->render_module(buffer.data(), rendered / kFrames % 3, kFrames, &b);
+	rendered += kFrames;
+    }
+    CHECK(playing == &b);
+    // a's first cycle has frames_per_cycle - 1 frames
+    CHECK((frames_per_cycle(666) - 1) / kFrames * kFrames + kFrames == rendered);
+    return true;
+}
+
+bool check_no_handover()
+{
+    SStream a = make_stream(250, 1332, false), a_ref = make_stream(250, 1332, false);
+    a.reset(7); a_ref.reset(7);
+    vector<uint16_t> buffer(kSequenceSamples), ref(kSequenceSamples);
+    for(uint32_t n = 0; n < 3 * frames_per_cycle(1332) / kFrames; n++) {
+	CHECK(a.render(buffer.data(), kFrames, &a) == &a);
+	CHECK(a.render(buffer.data(), kFrames, nullptr) == &a);
+	a_ref.render(ref.data(), kFrames);
+	a_ref.render(ref.data(), kFrames);
+	CHECK(buffer == ref);
+    }
+    return true;
+}
+
+int main()
+{
+    bool ok = check_cycle_handover();
+    ok &= check_pattern_handover();
+    ok &= check_render_module();
+    ok &= check_no_handover();
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
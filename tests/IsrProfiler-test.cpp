@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks IsrProfiler.hpp with the mocked cycle counter:
+ *
+ * - min, avg and max of the durations and the gaps between calls
+ * - the log2 histogram buckets, first and last bucket included
+ * - wrap around of the 32 bit counter
+ * - reset() and the first gap after it
+ * - the kIsrProfile message
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/IsrProfiler.hpp"
+#include "../VHP-Vibro-Glove2/src/Message.hpp"
+#include "test-util.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+/*
+ * A handler call at cycle start, taking duration cycles
+ */
+void call(IsrProfiler& profiler, uint32_t start, uint32_t duration)
+{
+    g_mock_cycles = start;
+    profiler.begin();
+    g_mock_cycles = (uint32_t) (start + duration);
+    profiler.end();
+}
+
+bool check_stats()
+{
+    IsrProfiler profiler;
+    CHECK(profiler.stats().count == 0 && profiler.stats().avg() == 0 && profiler.stats().gap_avg() == 0);
+
+    // a call every 10000 cycles
+    call(profiler, 1000, 300);
+    call(profiler, 11000, 500);
+    call(profiler, 21000, 100);
+    call(profiler, 31500, 3100);
+
+    const auto& s = profiler.stats();
+    CHECK(s.count == 4);
+    CHECK(s.min == 100 && s.max == 3100 && s.avg() == 1000);
+    CHECK(s.gaps == 3);
+    CHECK(s.gap_min == 10000 && s.gap_max == 10500 && s.gap_avg() == 10166);
+
+    // 100 in [64, 128), 300 in [256, 512), 500 as well, 3100 in [2048, 4096)
+    CHECK(s.histogram[0] == 1 && s.histogram[2] == 2 && s.histogram[5] == 1);
+
+    // the counter wraps
+    call(profiler, UINT32_MAX - 50, 200);
+    CHECK(profiler.stats().max == 3100 && profiler.stats().count == 5);
+    CHECK(profiler.stats().gap_max == UINT32_MAX - 50 - 31500);
+
+    profiler.reset();
+    call(profiler, 5, 40);
+    CHECK(profiler.stats().count == 1 && profiler.stats().min == 40 && profiler.stats().gaps == 0);
+    return true;
+}
+
+bool check_buckets()
+{
+    CHECK(IsrProfiler::bucket(0) == 0);
+    CHECK(IsrProfiler::bucket(127) == 0);
+    CHECK(IsrProfiler::bucket(128) == 1);
+    CHECK(IsrProfiler::bucket(255) == 1);
+    CHECK(IsrProfiler::bucket(256) == 2);
+    CHECK(IsrProfiler::bucket(1u << (IsrProfiler::kFirstBucketLog2 + IsrProfiler::kBuckets - 1)) == IsrProfiler::kBuckets - 1);
+    CHECK(IsrProfiler::bucket(UINT32_MAX) == IsrProfiler::kBuckets - 1);
+    return true;
+}
+
+bool check_message()
+{
+    IsrProfiler profiler;
+    Message message;
+    message.WriteIsrProfile(profiler.stats(), 64000000);
+    CHECK(message.type() == MessageType::kIsrProfile);
+    CHECK(message.payload().size() == 8 * 4 + IsrProfiler::kBuckets * 4);
+    // no calls: min reported as 0
+    CHECK(LittleEndianReadU32(message.payload().data() + 4) == 0);
+
+    call(profiler, 0, 1000);
+    call(profiler, 10000, 3000);
+    message.WriteIsrProfile(profiler.stats(), 64000000);
+    const uint8_t* p = message.payload().data();
+    const vector<uint32_t> expected = { 2, 1000, 2000, 3000, 10000, 10000, 10000, 64000000 };
+    for(size_t i = 0; i < expected.size(); i++)
+	CHECK(LittleEndianReadU32(p + 4 * i) == expected[i]);
+    // 1000 in [512, 1024), 3000 in [2048, 4096)
+    CHECK(LittleEndianReadU32(p + 32 + 3 * 4) == 1);
+    CHECK(LittleEndianReadU32(p + 32 + 5 * 4) == 1);
+
+    bool reset = true;
+    Message request;
+    request.data()[2] = static_cast<uint8_t>(MessageType::kGetIsrProfile);
+    request.data()[3] = 0;
+    CHECK(request.ReadGetIsrProfile(&reset) && !reset);
+    request.data()[3] = 1;
+    request.data()[Message::kHeaderSize] = 1;
+    CHECK(request.ReadGetIsrProfile(&reset) && reset);
+    return true;
+}
+
+int main()
+{
+    bool ok = check_stats();
+    ok &= check_buckets();
+    ok &= check_message();
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
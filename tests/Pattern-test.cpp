@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the pattern engine of Pattern.hpp and PatternUpload.hpp:
+ *
+ * - Pattern::valid() accepts the documented format only
+ * - every channel of SStream::render() plays the last event in the
+ *   list that covers the frame, from phase 0 at the event's onset and
+ *   with its amplitude, and silence outside events, period after
+ *   period
+ * - render_module() and the mirrored mode (chan8 == false) agree
+ * - kSine events play the sine while a waveform is uploaded
+ * - PatternUpload only takes complete patterns with a valid checksum
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/PatternUpload.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t samplerate = 46875;
+const uint32_t stimfreq = 250;
+const uint16_t volume = 200;
+
+struct TestEvent {
+    uint8_t channels;
+    uint8_t amplitude;
+    uint8_t waveform;
+    uint16_t onset;
+    uint16_t duration;
+};
+
+vector<uint8_t> encode(uint16_t period, const vector<TestEvent>& events)
+{
+    vector<uint8_t> data = { Pattern::kVersion, (uint8_t) events.size(),
+			     (uint8_t) period, (uint8_t) (period >> 8) };
+    for(const auto& e : events) {
+	const uint8_t bytes[Pattern::kEventSize] = {
+	    e.channels, e.amplitude, e.waveform, 0,
+	    (uint8_t) e.onset, (uint8_t) (e.onset >> 8),
+	    (uint8_t) e.duration, (uint8_t) (e.duration >> 8) };
+	data.insert(data.end(), bytes, bytes + Pattern::kEventSize);
+    }
+    return data;
+}
+
+uint32_t ms_to_frames(uint32_t ms)
+{
+    return (ms * samplerate / 1000 + 4) / 8;
+}
+
+// channel 0 is interrupted by the third event, channels 2 and 5
+// overlap with it
+const uint16_t period = 200;
+const vector<TestEvent> events = {
+    { 0x01, 255, Pattern::kSine, 0, 100 },
+    { 0x24, 128, Pattern::kSine, 50, 100 },
+    { 0x01, 64, Pattern::kSine, 20, 10 },
+};
+
+bool check_valid()
+{
+    const auto good = encode(period, events);
+    CHECK(Pattern::valid(good.data(), good.size()));
+    CHECK(!Pattern::valid(good.data(), good.size() - 1));
+    CHECK(!Pattern::valid(good.data(), 3));
+
+    auto bad = good;
+    bad[0] = 2;
+    CHECK(!Pattern::valid(bad.data(), bad.size()));
+
+    CHECK(!Pattern::valid(encode(0, {}).data(), Pattern::kHeaderSize));
+    CHECK(Pattern::valid(encode(1, {}).data(), Pattern::kHeaderSize));
+
+    const vector<vector<TestEvent>> invalid = {
+	{ { 0x00, 255, Pattern::kSine, 0, 10 } },
+	{ { 0x01, 255, 2, 0, 10 } },
+	{ { 0x01, 255, Pattern::kSine, 0, 0 } },
+	{ { 0x01, 255, Pattern::kSine, 150, 51 } },
+    };
+    for(const auto& e : invalid) {
+	const auto data = encode(period, e);
+	CHECK(!Pattern::valid(data.data(), data.size()));
+    }
+
+    // the high channel mask has bits for channels 8..11 only
+    bad = good;
+    bad[Pattern::kHeaderSize + 3] = 0x10;
+    CHECK(!Pattern::valid(bad.data(), bad.size()));
+
+    const auto too_many = encode(period, vector<TestEvent>(Pattern::kMaxEvents + 1, events[0]));
+    CHECK(!Pattern::valid(too_many.data(), too_many.size()));
+    return true;
+}
+
+vector<uint16_t> render(bool chan8, uint32_t sequences, int module = -1)
+{
+    const auto pattern = encode(period, events);
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(chan8), samplerate, stimfreq, 100, 1332, 5, 2, 235, volume, false, 0, 0,
+	       nullptr, 0, nullptr, pattern.data(), pattern.size());
+
+    vector<uint16_t> out(sequences * kSequenceSamples);
+    for(uint32_t n = 0; n < sequences; n++) {
+	uint16_t* dest = &out[n * kSequenceSamples];
+	if(module < 0)
+	    ss.render(dest, kFrames);
+	else
+	    ss.render_module(dest + module * kModuleSamples, module, kFrames);
+    }
+    return out;
+}
+
+/*
+ * @return sample i of frame of channel, as played by the pattern
+ */
+uint16_t expected(const SampleCache& cache, uint32_t channel, uint32_t frame, uint32_t i)
+{
+    frame %= ms_to_frames(period);
+    for(size_t k = events.size(); k-- > 0; ) {
+	const auto& e = events[k];
+	const uint32_t onset = ms_to_frames(e.onset);
+	const uint32_t offset = ms_to_frames(e.onset + e.duration);
+	if(!(e.channels & (1 << channel)) || frame < onset || frame >= offset)
+	    continue;
+
+	const uint32_t phase = (frame - onset) * 8 % (samplerate / stimfreq);
+	const int32_t gain = (e.amplitude * 32768 + 127) / 255;
+	const int32_t sample = cache.get_sample(phase + i, volume);
+	return volume + ((sample - volume) * gain >> 15);
+    }
+    return volume;
+}
+
+uint16_t played(const vector<uint16_t>& out, uint32_t physical, uint32_t frame, uint32_t i)
+{
+    const uint32_t sequence = frame / kFrames;
+    const uint32_t sample = frame % kFrames * 8 + i;
+    return out[sequence * kSequenceSamples + physical / 4 * kModuleSamples + sample * 4 + physical % 4];
+}
+
+bool check_render()
+{
+    const SampleCache cache(samplerate, stimfreq);
+    // two and a half periods
+    const uint32_t frames = ms_to_frames(period) * 5 / 2;
+    const uint32_t sequences = (frames + kFrames - 1) / kFrames;
+
+    const auto out = render(true, sequences);
+    uint32_t playing = 0;
+    for(uint32_t frame = 0; frame < frames; frame++)
+	for(uint32_t channel = 0; channel < 8; channel++)
+	    for(uint32_t i = 0; i < 8; i++) {
+		const uint16_t e = expected(cache, channel, frame, i);
+		if(played(out, order_pairs[channel], frame, i) != e) {
+		    cout << "FAIL channel " << channel << " frame " << frame << " sample " << i
+			 << ": " << played(out, order_pairs[channel], frame, i) << " expected " << e << endl;
+		    return false;
+		}
+		playing += e != volume;
+	    }
+    cout << playing << " samples played" << endl;
+    CHECK(playing > 0);
+
+    vector<uint16_t> per_module(out.size());
+    for(int module = 0; module < ChannelMap::kNumModules; module++) {
+	const auto m = render(true, sequences, module);
+	for(uint32_t n = 0; n < sequences; n++)
+	    for(uint32_t s = 0; s < kModuleSamples; s++) {
+		const uint32_t k = n * kSequenceSamples + module * kModuleSamples + s;
+		per_module[k] = m[k];
+	    }
+    }
+    CHECK(per_module == out);
+
+    // mirrored: channels 0-3 play on both tactors, bit 5 is ignored
+    const auto mirrored = render(false, sequences);
+    for(uint32_t frame = 0; frame < frames; frame++)
+	for(uint32_t channel = 0; channel < 4; channel++)
+	    for(uint32_t i = 0; i < 8; i++) {
+		const uint16_t e = expected(cache, channel, frame, i);
+		CHECK(played(mirrored, order_pairs[channel], frame, i) == e);
+		CHECK(played(mirrored, order_pairs[7 - channel], frame, i) == e);
+	    }
+    return true;
+}
+
+/*
+ * With an uploaded waveform, kSine events still play the sine
+ */
+bool check_waveforms()
+{
+    const int16_t square[] = { 20000, 20000, -20000, -20000 };
+    const auto pattern = encode(period, {
+	    { 0x01, 255, Pattern::kSine, 0, 100 },
+	    { 0x02, 255, Pattern::kUploaded, 0, 100 } });
+    SStream ss(ChannelMap(true), samplerate, stimfreq, 100, 1332, 5, 2, 235, volume, false, 0, 0,
+	       square, 4, nullptr, pattern.data(), pattern.size());
+    const SampleCache sine(samplerate, stimfreq);
+    const SampleCache uploaded(samplerate, stimfreq, SampleCache::kTable, square, 4);
+
+    const uint32_t sequences = ms_to_frames(100) / kFrames;
+    const auto out = render_sequences(ss, sequences);
+
+    for(uint32_t frame = 0; frame < sequences * kFrames; frame++)
+	for(uint32_t i = 0; i < 8; i++) {
+	    const uint32_t phase = frame * 8 % (samplerate / stimfreq);
+	    CHECK(played(out, order_pairs[0], frame, i) == sine.get_sample(phase + i, volume));
+	    CHECK(played(out, order_pairs[1], frame, i) == uploaded.get_sample(phase + i, volume));
+	}
+    return true;
+}
+
+bool check_upload()
+{
+    const auto pattern = encode(period, events);
+    PatternUpload upload;
+    CHECK(upload.data() == nullptr && upload.size() == 0);
+
+    CHECK(upload.write_chunk(0, pattern.data(), 10));
+    CHECK(upload.write_chunk(10, pattern.data() + 10, pattern.size() - 10));
+    CHECK(!upload.write_chunk(Pattern::kMaxSize - 1, pattern.data(), 2));
+
+    const uint16_t checksum = ::Fletcher16(pattern.data(), pattern.size(), 1);
+    CHECK(!upload.commit(pattern.size(), checksum ^ 1));
+    CHECK(!upload.commit(Pattern::kMaxSize + 1, checksum));
+    CHECK(upload.commit(pattern.size(), checksum));
+    CHECK(upload.size() == pattern.size());
+    CHECK(vector<uint8_t>(upload.data(), upload.data() + upload.size()) == pattern);
+
+    // a checksum of an invalid pattern is not enough
+    auto bad = pattern;
+    bad[0] = 0;
+    CHECK(upload.write_chunk(0, bad.data(), bad.size()));
+    CHECK(!upload.commit(bad.size(), ::Fletcher16(bad.data(), bad.size(), 1)));
+    CHECK(upload.size() == pattern.size());
+
+    const auto active = upload.active();
+    CHECK(upload.commit(0, 0));
+    CHECK(upload.data() == nullptr && upload.active().size == 0);
+    CHECK(vector<uint8_t>(active.data, active.data + active.size) == pattern);
+    return true;
+}
+
+int main()
+{
+    bool ok = check_valid();
+    ok &= check_render();
+    ok &= check_waveforms();
+    ok &= check_upload();
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks that rendering PWM sequences of 8, 32, 64 and 128 samples
+ * into ping-pong buffers with SStream::render() and
+ * SStream::render_module() gives byte-identical output to the 8
+ * sample, channel by channel path.
+ */
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include "arduino-mock.hpp"
+
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/Settings.hpp"
+#include "../VHP-Vibro-Glove2/src/BoardDefs.hpp"
+
+using namespace std;
+
+
+template<int kFrameLength>
+class MockPwm 
+{
+public:
+    enum {
+	kNumModules = 3,
+	kChannelsPerModule = 4,
+	kSamplesPerModule = kFrameLength * kChannelsPerModule,
+    };
+
+    array<array<uint16_t, kNumModules * kSamplesPerModule>, 2> pwm_buffer_;
+    int idle_half_ = 0;
+
+    // Gets pointer to the start of `module` in the idle half of pwm_buffer_.
+    uint16_t* GetModulePointer(int module) {
+	return pwm_buffer_[idle_half_].data() + kSamplesPerModule * module;
+    }
+
+    // Gets pointer to the start of `channel` in the idle half of pwm_buffer_.
+    uint16_t* GetChannelPointer(int orig_channel) {
+	const auto channel = order_pairs[orig_channel];
+	return GetModulePointer(channel / kChannelsPerModule) +
+		(channel % kChannelsPerModule);
+    }
+
+    // Appends the idle half, as it would be played, to `out` and
+    // swaps halves.
+    void Play(vector<array<uint16_t, 8>>& out) {
+	for (int i = 0; i < kFrameLength; ++i) {
+	    array<uint16_t, 8> sample;
+	    for (int channel = 0; channel < 8; ++channel)
+		sample[channel] = GetChannelPointer(channel)[i * kChannelsPerModule];
+	    out.push_back(sample);
+	}
+	idle_half_ ^= 1;
+    }
+};
+
+
+/*
+ * Mirrors OnPwmSequenceEnd() in VHP-Vibro-Glove2.ino, with a single
+ * clock: each sequence all three modules are rendered.
+ */
+template<int kFrameLength>
+vector<array<uint16_t, 8>> render(bool chan8, uint16_t jitter, uint32_t samples)
+{
+    constexpr uint32_t kFramesPerSequence = kFrameLength / SStream::samples_per_frame();
+    const uint16_t volume = 77;
+
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(chan8), 46875, 250, 100, chan8 ? 1332 : 666, 5, 2, jitter, volume, false);
+    MockPwm<kFrameLength> pwm;
+    vector<array<uint16_t, 8>> out;
+
+    while(out.size() < samples) {
+	ss.render(pwm.GetModulePointer(0), kFramesPerSequence);
+	pwm.Play(out);
+    }
+
+    out.resize(samples);
+    return out;
+}
+
+
+/*
+ * As render(), but every module is rendered with render_module() by
+ * a stream of its own. As the streams get the same seed, the output
+ * must be the same.
+ */
+template<int kFrameLength>
+vector<array<uint16_t, 8>> render_per_module(bool chan8, uint16_t jitter, uint32_t samples)
+{
+    constexpr uint32_t kFramesPerSequence = kFrameLength / SStream::samples_per_frame();
+    constexpr int kNumModules = MockPwm<kFrameLength>::kNumModules;
+    const uint16_t volume = 77;
+
+    vector<vector<array<uint16_t, 8>>> module_out(kNumModules);
+    for(int module = 0; module < kNumModules; module++) {
+	g_mock_micros = 12345;
+	SStream ss(ChannelMap(chan8), 46875, 250, 100, chan8 ? 1332 : 666, 5, 2, jitter, volume, false);
+	MockPwm<kFrameLength> pwm;
+
+	while(module_out[module].size() < samples) {
+	    ss.render_module(pwm.GetModulePointer(module), module, kFramesPerSequence);
+	    pwm.Play(module_out[module]);
+	}
+    }
+
+    vector<array<uint16_t, 8>> out(samples);
+    for(uint32_t i = 0; i < samples; i++)
+	for(int channel = 0; channel < 8; channel++)
+	    out[i][channel] = module_out[order_pairs[channel] / 4][i][channel];
+    return out;
+}
+
+
+/*
+ * As render<32>(), with a stream that already played for a while and
+ * is restarted by reset(), as ToggleStream() does with the prepared
+ * stream. Must equal a new stream.
+ */
+vector<array<uint16_t, 8>> render_restarted(bool chan8, uint16_t jitter, uint32_t samples)
+{
+    constexpr uint32_t kFramesPerSequence = 32 / SStream::samples_per_frame();
+    const uint16_t volume = 77;
+
+    g_mock_micros = 999;
+    SStream ss(ChannelMap(chan8), 46875, 250, 100, chan8 ? 1332 : 666, 5, 2, jitter, volume, false);
+    MockPwm<32> pwm;
+    vector<array<uint16_t, 8>> out;
+
+    while(out.size() < samples / 3) {
+	ss.render(pwm.GetModulePointer(0), kFramesPerSequence);
+	pwm.Play(out);
+    }
+
+    g_mock_micros = 12345;
+    ss.reset();
+    out.clear();
+    MockPwm<32> restarted_pwm;
+    while(out.size() < samples) {
+	ss.render(restarted_pwm.GetModulePointer(0), kFramesPerSequence);
+	restarted_pwm.Play(out);
+    }
+
+    out.resize(samples);
+    return out;
+}
+
+
+/*
+ * Reference: renders 8 sample sequences channel by channel, with the
+ * chan8 == false mirroring done by hand.
+ */
+vector<array<uint16_t, 8>> render_channels(bool chan8, uint16_t jitter, uint32_t samples)
+{
+    const uint16_t volume = 77;
+
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(chan8), 46875, 250, 100, chan8 ? 1332 : 666, 5, 2, jitter, volume, false);
+    MockPwm<8> pwm;
+    vector<array<uint16_t, 8>> out;
+
+    while(out.size() < samples) {
+	ss.next_sample_frame();
+	const auto active_channel = ss.current_active_channel();
+	
+	for(uint32_t channel = 0; channel < ss.channels(); channel++) {
+	    ss.set_chan_samples(pwm.GetChannelPointer(channel), channel == active_channel ? channel : UINT32_MAX);
+	    if(!chan8)
+		ss.set_chan_samples(pwm.GetChannelPointer(7-channel), channel == active_channel ? channel : UINT32_MAX);
+	}
+
+	pwm.Play(out);
+    }
+
+    out.resize(samples);
+    return out;
+}
+
+
+template<int kFrameLength>
+bool compare(bool chan8, uint16_t jitter, const vector<array<uint16_t, 8>>& reference)
+{
+    const auto out = render<kFrameLength>(chan8, jitter, reference.size());
+    const auto out_per_module = render_per_module<kFrameLength>(chan8, jitter, reference.size());
+    for(size_t i = 0; i < out.size(); i++)
+	if(out[i] != reference[i] || out_per_module[i] != reference[i]) {
+	    cout << "FAIL frame length " << kFrameLength << " chan8 " << chan8
+		 << " jitter " << jitter << ": differs at sample " << i << endl;
+	    return false;
+	}
+
+    cout << "OK frame length " << kFrameLength << " chan8 " << chan8
+	 << " jitter " << jitter << endl;
+    return true;
+}
+
+
+int main() 
+{
+    // 3 full pauze-cycle periods
+    const uint32_t samples = 3 * 5 * 62464;
+    bool ok = true;
+
+    for(bool chan8 : { true, false })
+	for(uint16_t jitter : { 0, 235 }) {
+	    const auto reference = render_channels(chan8, jitter, samples);
+	    ok &= compare<8>(chan8, jitter, reference);
+	    ok &= compare<32>(chan8, jitter, reference);
+	    ok &= compare<64>(chan8, jitter, reference);
+	    ok &= compare<128>(chan8, jitter, reference);
+
+	    const bool restarted_ok = render_restarted(chan8, jitter, samples) == reference;
+	    cout << (restarted_ok ? "OK" : "FAIL") << " reset() chan8 " << chan8
+		 << " jitter " << jitter << endl;
+	    ok &= restarted_ok;
+	}
+    
+    return ok ? 0 : 1;
+}
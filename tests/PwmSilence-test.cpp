@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks that Pwm::SilenceChannel() writes only on transitions, using
+ * the real PwmTactor.hpp on top of the nRF PWM mock in tests/nrf-mock.
+ *
+ * - a half that already holds the silence is not written again
+ * - a change of the level, and the first use of a half, are written
+ * - after samples were written, both halves play silence again
+ * - with VHP_PWM_SYNC, a stream writing the whole buffer of all
+ *   modules is followed by silence on every tactor after a stop
+ * - SStream::render() with the silence levels of two buffer halves
+ *   plays as without, and does not write the silence of idle slots
+ *   again
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/PwmTactor.hpp"
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+constexpr int kNumModules = 3;
+constexpr int kChannels = 8;
+// a value SilenceChannel() never writes
+constexpr uint16_t kMarker = 4321;
+
+uint16_t g_volume = 100;
+// channel playing samples in the callback, -1 for none
+int g_playing = -1;
+uint16_t g_sample = 0;
+// sync mode: a stream renders all modules, as SStream::render()
+bool g_rendering = false;
+
+/*
+ * Mirrors OnPwmSequenceEnd() and SilenceModules() in
+ * VHP-Vibro-Glove2.ino, with one channel or the whole buffer playing
+ * a constant instead of a stream. In sync mode the master module's
+ * callback fills all modules.
+ */
+void OnPwmSequenceEnd(uint8_t module) {
+    if(g_rendering) {
+	uint16_t* dest = PwmTactor.GetBufferPointer();
+	fill(dest, dest + kNumModules * kNumPwmValues * 4, g_sample);
+	return;
+    }
+    for(int i = 0; i < kChannels; i++) {
+	if(!kPwmSync && PwmTactor.GetChannelModule(i) != module)
+	    continue;
+	if(i == g_playing) {
+	    uint16_t* dest = PwmTactor.GetChannelPointer(i);
+	    for(int n = 0; n < kNumPwmValues; n++)
+		dest[n * 4] = g_sample;
+	} else
+	    PwmTactor.SilenceChannel(i, g_volume);
+    }
+}
+
+// first value of channel i in buffer half `half`, as the mock plays it
+uint16_t* buffer_value(int i, int half) {
+    const int channel = order_pairs[i];
+    return const_cast<uint16_t*>(g_mock_pwm[channel / 4].seq[half].ptr) + channel % 4;
+}
+
+void play_sequences(uint32_t sequences) {
+    for(uint32_t sample = 0; sample < sequences * kNumPwmValues; sample++) {
+	g_mock_ticks += mock_pwm_period(&g_mock_pwm[0]);
+	for(int m = 0; m < kNumModules; m++)
+	    mock_pwm_step(&g_mock_pwm[m]);
+
+	if(mock_pwm_irq_pending(0)) PWM0_IRQHandler();
+	if(mock_pwm_irq_pending(1)) PWM1_IRQHandler();
+	if(mock_pwm_irq_pending(2)) PWM2_IRQHandler();
+    }
+}
+
+// true if channel i played `value` for the last `samples` samples
+bool played(int i, uint16_t value, uint32_t samples) {
+    const int channel = order_pairs[i];
+    const auto& output = g_mock_pwm[channel / 4].output[channel % 4];
+    for(uint32_t n = output.size() - samples; n < output.size(); n++)
+	if(output[n] != value)
+	    return false;
+    return true;
+}
+
+/*
+ * Renders two buffer halves alternately with their silence levels, as
+ * OnPwmSequenceEnd() in VHP-Vibro-Glove2.ino does, next to a stream
+ * of the same seed that renders into a new buffer every time
+ */
+bool check_stream_silence()
+{
+    // the second cycle of 666 ms, from sequence 976 on, is pauzed
+    SStream tracked(ChannelMap(true), 46875, 250, 100, 666, 2, 1, 235, 100, false);
+    SStream reference(ChannelMap(true), 46875, 250, 100, 666, 2, 1, 235, 100, false);
+    tracked.reset(7);
+    reference.reset(7);
+
+    vector<uint16_t> halves[2] = { vector<uint16_t>(kSequenceSamples), vector<uint16_t>(kSequenceSamples) };
+    uint16_t levels[2][kNumModules * 4];
+    fill(&levels[0][0], &levels[2][0], kNotSilent);
+
+    uint32_t n = 0;
+    for(; n < 1500; n++) {
+	if(n == 200) {
+	    tracked.set_volume(150);
+	    reference.set_volume(150);
+	}
+	auto& half = halves[n % 2];
+	tracked.render(half.data(), kFrames, nullptr, levels[n % 2]);
+	vector<uint16_t> expected(kSequenceSamples);
+	reference.render(expected.data(), kFrames);
+	CHECK(half == expected);
+    }
+
+    // in the pauzed cycle every tactor holds the silence in both
+    // halves, which is not written again
+    for(int half = 0; half < 2; half++)
+	for(auto slot : order_pairs) {
+	    CHECK(levels[half][slot] == 150);
+	    for(uint32_t i = 0; i < kSequenceSamples; i++)
+		if(slot_of(i) == slot)
+		    halves[half][i] = kMarker;
+	}
+    for(int i = 0; i < 2; i++, n++)
+	tracked.render(halves[n % 2].data(), kFrames, nullptr, levels[n % 2]);
+    for(int half = 0; half < 2; half++)
+	for(auto slot : order_pairs)
+	    CHECK(slot_samples(halves[half], slot) == vector<uint16_t>(kFrames * SStream::samples_per_frame(), kMarker));
+    return true;
+}
+
+int main()
+{
+    PwmTactor.OnSequenceEnd(OnPwmSequenceEnd);
+    PwmTactor.Initialize(46875);
+    // the modules are started as on the device, where NRF_PWM0 starts
+    // by itself, see Pwm::StartPlayback()
+    nrf_pwm_task_trigger(NRF_PWM0, NRF_PWM_TASK_SEQSTART0);
+    PwmTactor.StartPlayback();
+
+    // both halves are written once, then play silence
+    play_sequences(4);
+    for(int i = 0; i < kChannels; i++) {
+	CHECK(*buffer_value(i, 0) == g_volume && *buffer_value(i, 1) == g_volume);
+	CHECK(played(i, g_volume, 2 * kNumPwmValues));
+    }
+
+    // silent halves are not written again
+    for(int i = 0; i < kChannels; i++)
+	*buffer_value(i, 0) = *buffer_value(i, 1) = kMarker;
+    play_sequences(4);
+    for(int i = 0; i < kChannels; i++)
+	CHECK(*buffer_value(i, 0) == kMarker && *buffer_value(i, 1) == kMarker);
+
+    // a volume change is written to both halves
+    g_volume = 120;
+    play_sequences(4);
+    for(int i = 0; i < kChannels; i++) {
+	CHECK(*buffer_value(i, 0) == g_volume && *buffer_value(i, 1) == g_volume);
+	CHECK(played(i, g_volume, 2 * kNumPwmValues));
+    }
+
+    // a burst ends in silence on both halves, the other channels stay
+    // untouched meanwhile
+    *buffer_value(1, 0) = *buffer_value(1, 1) = kMarker;
+    g_playing = 3;
+    g_sample = 300;
+    play_sequences(4);
+    CHECK(played(3, g_sample, 2 * kNumPwmValues));
+    CHECK(*buffer_value(1, 0) == kMarker && *buffer_value(1, 1) == kMarker);
+
+    g_playing = -1;
+    play_sequences(4);
+    CHECK(played(3, g_volume, 2 * kNumPwmValues));
+    CHECK(*buffer_value(1, 0) == kMarker && *buffer_value(1, 1) == kMarker);
+
+    // a module handed out whole is written again
+    PwmTactor.GetModulePointer(PwmTactor.GetChannelModule(1));
+    play_sequences(4);
+    CHECK(*buffer_value(1, 0) == g_volume || *buffer_value(1, 1) == g_volume);
+
+    // a stream of all modules stops in silence on every tactor
+    if(kPwmSync) {
+	g_rendering = true;
+	g_sample = 200;
+	play_sequences(4);
+	for(int i = 0; i < kChannels; i++)
+	    CHECK(played(i, g_sample, 2 * kNumPwmValues));
+
+	g_rendering = false;
+	play_sequences(4);
+	for(int i = 0; i < kChannels; i++)
+	    CHECK(played(i, g_volume, 2 * kNumPwmValues));
+    }
+
+    CHECK(check_stream_silence());
+
+    cout << "OK" << endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the frame cadence of the PWM in sync mode (VHP_PWM_SYNC=1),
+ * using the real PwmTactor.hpp on top of the nRF PWM mock in
+ * tests/nrf-mock.
+ *
+ * - the countertop gives the configured samplerate
+ * - all modules start together, only the master raises interrupts
+ * - the stream advances kNumPwmValues / 8 frames per sequence
+ * - every module plays every rendered frame exactly once, in order
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/PwmTactor.hpp"
+#include "test-util.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+static_assert(kPwmSync, "build with -DVHP_PWM_SYNC=1");
+
+constexpr uint32_t kFramesPerSequence = kNumPwmValues / SStream::samples_per_frame();
+constexpr uint32_t kFrameStride = SStream::samples_per_frame() * SStream::kChannelsPerModule;
+constexpr int kNumModules = 3;
+
+const uint32_t samplerate = 46875;
+const uint16_t volume = 77;
+
+SStream* g_stream;
+uint32_t g_callbacks = 0;
+uint32_t g_frames = 0;
+bool g_only_master = true;
+
+
+/*
+ * Mirrors OnPwmSequenceEnd() in VHP-Vibro-Glove2.ino
+ */
+void OnPwmSequenceEnd(uint8_t module) {
+    g_callbacks++;
+    g_only_master &= module == Pwm::kMasterModule;
+    
+    g_stream->render(PwmTactor.GetBufferPointer(), kFramesPerSequence);
+    g_frames += kFramesPerSequence;
+}
+
+SStream make_stream() {
+    g_mock_micros = 12345;
+    return SStream(ChannelMap(true), samplerate, 250, 100, 1332, 5, 2, 235, volume, false);
+}
+
+int main() 
+{
+    SStream stream = make_stream();
+    g_stream = &stream;
+    
+    PwmTactor.OnSequenceEnd(OnPwmSequenceEnd);
+    PwmTactor.Initialize(samplerate);
+
+    const double rate_error = fabs((double) PwmTactor.GetSampleRate() - samplerate) / samplerate;
+    cout << "PWM samplerate " << PwmTactor.GetSampleRate() << " Hz, top " << g_mock_pwm[0].top << endl;
+    CHECK(rate_error < 0.002);
+    CHECK(PwmTactor.ScaleLevel(Pwm::kTopValue) == g_mock_pwm[0].top);
+    
+    for(int m = 0; m < kNumModules; m++) {
+	const bool master = m == Pwm::kMasterModule;
+	CHECK(g_mock_nvic_enabled[m] == master);
+	CHECK((g_mock_pwm[m].inten != 0) == master);
+	CHECK(g_mock_pwm[m].top == g_mock_pwm[0].top);
+	CHECK(g_mock_pwm[m].clock == g_mock_pwm[0].clock);
+    }
+
+    g_mock_ticks = 1000;
+    PwmTactor.StartPlayback();
+    for(int m = 0; m < kNumModules; m++) {
+	CHECK(g_mock_pwm[m].starts == 1);
+	CHECK(g_mock_pwm[m].started_at == g_mock_pwm[0].started_at);
+    }
+
+    // play a bit over one second
+    const uint32_t sequences = samplerate / kNumPwmValues + 3;
+    for(uint32_t sample = 0; sample < sequences * kNumPwmValues; sample++) {
+	g_mock_ticks += mock_pwm_period(&g_mock_pwm[0]);
+	for(int m = 0; m < kNumModules; m++)
+	    mock_pwm_step(&g_mock_pwm[m]);
+
+	if(mock_pwm_irq_pending(0)) PWM0_IRQHandler();
+	if(mock_pwm_irq_pending(1)) PWM1_IRQHandler();
+	if(mock_pwm_irq_pending(2)) PWM2_IRQHandler();
+    }
+
+    cout << "sequences " << sequences << ", callbacks " << g_callbacks << ", frames " << g_frames << endl;
+    CHECK(g_only_master);
+    CHECK(g_callbacks == sequences);
+    CHECK(g_frames == sequences * kFramesPerSequence);
+    for(int m = 0; m < kNumModules; m++)
+	for(int slot = 0; slot < 4; slot++)
+	    CHECK(g_mock_pwm[m].output[slot].size() == sequences * kNumPwmValues);
+
+    // Both halves play once before the first rendered sequence.
+    SStream reference = make_stream();
+    const uint32_t latency = 2 * kNumPwmValues;
+    uint16_t buffer[kNumModules][kFrameStride];
+    const ChannelMap channel_map(order_pairs, true);
+    
+    for(uint32_t frame = 0; frame < (sequences - 2) * kFramesPerSequence; frame++) {
+	reference.render(buffer[0], 1);
+	for(int m = 0; m < kNumModules; m++) {
+
+	    for(int slot = 0; slot < 4; slot++)
+		for(uint32_t i = 0; i < SStream::samples_per_frame(); i++) {
+		    const auto played = g_mock_pwm[m].output[slot][latency + frame * SStream::samples_per_frame() + i];
+		    if(channel_map.source(m, slot) != ChannelMap::kNoChannel)
+			CHECK(played == buffer[m][i * SStream::kChannelsPerModule + slot]);
+		}
+	}
+    }
+
+    cout << "OK" << endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Cost of the random numbers SStream draws at a cycle boundary: a
+ * shuffle of the 8 channels and 8 jitters.
+ *
+ * The former code drew them with Arduino random(), through an
+ * adaptor for std::shuffle. On the host random(r) is rand() % r (see
+ * arduino-mock.hpp), on the nrf52840 it is a division of rand() as
+ * well. Random.hpp replaces both.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <array>
+#include <numeric>
+#include <algorithm>
+#include <stdint.h>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/Random.hpp"
+
+using namespace std;
+
+/*
+ * Former SStream::shuffle_channel_order_() and calc_channel_jitter_()
+ */
+struct ArduinoRandom {
+    struct RandInt {
+	using result_type = uint32_t;
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT32_MAX-1; }
+	result_type operator()() { return random(UINT32_MAX); }
+    };
+
+    void cycle(array<uint32_t, 8>& order, array<int32_t, 8>& jitter, uint32_t max_jitter) {
+	std::shuffle(order.begin(), order.end(), RandInt());
+	std::generate(jitter.begin(), jitter.end(), [=]() { return random(max_jitter); });
+    }
+};
+
+struct XoshiroRandom {
+    Random random;
+
+    void cycle(array<uint32_t, 8>& order, array<int32_t, 8>& jitter, uint32_t max_jitter) {
+	random.shuffle(order.begin(), order.end());
+	std::generate(jitter.begin(), jitter.end(), [=]() { return random.below(max_jitter); });
+    }
+};
+
+
+template<typename Generator>
+double bench(Generator& generator, uint32_t cycles, uint32_t* checksum)
+{
+    array<uint32_t, 8> order;
+    array<int32_t, 8> jitter;
+    iota(order.begin(), order.end(), 0);
+    // max_jitter_ of the default settings: 235 * 1332 / 8 / 1000
+    const uint32_t max_jitter = 39;
+    uint32_t sum = 0;
+
+    const auto t0 = chrono::steady_clock::now();
+    for(uint32_t n = 0; n < cycles; n++) {
+	generator.cycle(order, jitter, max_jitter);
+	sum += order[n % 8] + jitter[n % 8];
+    }
+    const auto t1 = chrono::steady_clock::now();
+
+    *checksum = sum;
+    return chrono::duration<double, nano>(t1 - t0).count() / cycles;
+}
+
+
+int main()
+{
+    const uint32_t cycles = 5000000;
+
+    randomSeed(1234);
+    ArduinoRandom arduino;
+    XoshiroRandom xoshiro{ Random(1234) };
+
+    uint32_t asum, xsum;
+    const double ans = bench(arduino, cycles, &asum);
+    const double xns = bench(xoshiro, cycles, &xsum);
+
+    cout << "cycle boundary: random() " << ans << " ns/cycle, xoshiro128** "
+	 << xns << " ns/cycle, " << ans / xns << "x"
+	 << " (" << asum << "/" << xsum << ")" << endl;
+
+    return 0;
+}
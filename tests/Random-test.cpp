@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the generator of Random.hpp:
+ *
+ * - the first numbers for a few seeds match an independent
+ *   implementation of splitmix64 seeding and xoshiro128**
+ * - below() stays in range and is unbiased, also for bounds where
+ *   modulo would favour the low numbers
+ * - shuffle() gives every permutation equally often
+ * - an SStream replays the same samples for the same seed, whatever
+ *   micros() returned at construction
+ */
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <map>
+#include <cmath>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/Random.hpp"
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+bool check_reference()
+{
+    const struct {
+	uint32_t seed;
+	uint32_t numbers[4];
+    } reference[] = {
+	{ 0, { 0xdec9045d, 0x9a089d75, 0xab77d362, 0xc3e16405 } },
+	{ 1, { 0x650941ba, 0x54d30301, 0x25d2f321, 0x3fabdca9 } },
+	{ 20250322, { 0xa2391b4b, 0x61710e47, 0xc31a7eb3, 0xacf21c82 } },
+    };
+
+    for(const auto& r : reference) {
+	Random random(r.seed);
+	for(uint32_t expected : r.numbers)
+	    CHECK(random() == expected);
+
+	// seed() restarts the sequence
+	random.seed(r.seed);
+	CHECK(random() == r.numbers[0]);
+    }
+    return true;
+}
+
+bool check_below()
+{
+    Random random(42);
+    CHECK(random.below(0) == 0);
+    CHECK(random.below(1) == 0);
+
+    // chi-square of 10 buckets, 9 degrees of freedom: 27.9 is p = 0.001
+    const uint32_t draws = 1000000;
+    array<uint32_t, 10> buckets{};
+    for(uint32_t i = 0; i < draws; i++) {
+	const uint32_t v = random.below(buckets.size());
+	CHECK(v < buckets.size());
+	buckets[v]++;
+    }
+    double chi2 = 0;
+    for(uint32_t count : buckets)
+	chi2 += pow(count - draws / 10.0, 2) / (draws / 10.0);
+    cout << "below(10) chi-square " << chi2 << endl;
+    CHECK(chi2 < 27.9);
+
+    // 2^32 % (3 * 2^30) == 2^30: modulo would draw from the first
+    // 2^30 numbers half of the time instead of a third
+    const uint32_t bound = 3u << 30;
+    uint32_t low = 0;
+    for(uint32_t i = 0; i < draws; i++) {
+	const uint32_t v = random.below(bound);
+	CHECK(v < bound);
+	low += v < (1u << 30);
+    }
+    cout << "below(3 << 30) low third " << double(low) / draws << endl;
+    CHECK(fabs(double(low) / draws - 1.0 / 3) < 0.003);
+    return true;
+}
+
+bool check_shuffle()
+{
+    Random random(7);
+    const uint32_t draws = 240000;
+    map<array<uint32_t, 4>, uint32_t> permutations;
+    for(uint32_t i = 0; i < draws; i++) {
+	array<uint32_t, 4> a = {{ 0, 1, 2, 3 }};
+	random.shuffle(a.begin(), a.end());
+	permutations[a]++;
+    }
+
+    CHECK(permutations.size() == 24);
+    for(const auto& p : permutations)
+	CHECK(fabs(p.second - draws / 24.0) < 0.05 * draws / 24.0);
+    return true;
+}
+
+vector<uint16_t> render(uint32_t seed, unsigned long construct_micros, bool reset)
+{
+    const uint32_t frames = 4;
+    const uint32_t samples = frames * SStream::samples_per_frame() * SStream::kChannelsPerModule * 3;
+
+    g_mock_micros = construct_micros;
+    SStream ss(ChannelMap(true), 46875, 250, 100, 1332, 5, 2, 235, 100, false);
+    if(reset)
+	ss.reset(seed);
+
+    // two pauze-cycle periods
+    vector<uint16_t> out(2 * 5 * 62464 / (frames * SStream::samples_per_frame()) * samples);
+    for(uint32_t n = 0; n < out.size(); n += samples)
+	ss.render(&out[n], frames);
+    return out;
+}
+
+bool check_replay()
+{
+    const auto reference = render(1234, 1234, false);
+    CHECK(render(1234, 99, true) == reference);
+    CHECK(render(1234, 1234, true) == reference);
+    CHECK(render(4321, 1234, true) != reference);
+
+    g_mock_micros = 555;
+    SStream ss(ChannelMap(true), 46875, 250, 100, 1332, 5, 2, 235, 100, false);
+    CHECK(ss.seed() == 555);
+    ss.reset(77);
+    CHECK(ss.seed() == 77);
+    return true;
+}
+
+int main()
+{
+    bool ok = check_reference();
+    ok &= check_below();
+    ok &= check_shuffle();
+    ok &= check_replay();
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,410 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Cost of the synthesis hot path on the host, for every preset of
+ * webui/presets.json:
+ *
+ *   next_sample_frame       ns/frame, and separately the two frames
+ *                           of a cycle boundary: the rollover and the
+ *                           frame that prepares the next schedule
+ *   set_chan_samples        ns/frame, all 8 channels, as the former
+ *                           PWM interrupt did, without advancing
+ *   render                  ns/frame, all channels mapped to the slots
+ *   SilenceChannel          ns/frame, all 8 channels
+ *   shuffle_channel_order_  ns/cycle, one shuffle of the 8 channels
+ *   get_sample              ns/frame, 8 samples
+ *
+ * SilenceChannel() lives in PwmTactor.hpp and shuffle_channel_order_()
+ * is private, both are measured on a copy of their loop.
+ *
+ *   $ sstream-bench --json bench.json
+ *   $ sstream-bench --baseline bench.json --threshold 20 --repeat 5
+ *
+ * The presets are read from --presets, by default webui/presets.json
+ * of the source tree, as vhp-render --preset reads them.
+ *
+ * Every benchmark runs --repeat times, the fastest run is reported,
+ * as it is the least disturbed by the rest of the system.
+ *
+ * --baseline compares the averages with an earlier --json output and
+ * fails if one is more than threshold percent slower. Timings depend
+ * on the machine and the build, compare with a baseline of the same
+ * machine. The worst cases time every call and include the overhead
+ * of the clock.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/Settings.hpp"
+#include "../VHP-Vibro-Glove2/src/BoardDefs.hpp"
+#include "../tools/presets.hpp"
+
+using namespace std;
+
+#ifndef VHP_PRESETS
+#define VHP_PRESETS "webui/presets.json"
+#endif
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+/*
+ * Stream settings of a preset, applied to the defaults of
+ * Settings.hpp, with the volume as VolumeLevel() in
+ * VHP-Vibro-Glove2.ino computes it
+ */
+struct PresetStream {
+    string name;
+    Settings settings;
+    uint32_t volume_percent;
+
+    uint16_t volume() const { return volume_percent * settings.vol_amplitude / 100; }
+};
+
+const uint32_t frames_per_sequence = audio_tactile::kNumPwmValues / SStream::samples_per_frame();
+const uint32_t sequence_samples = ChannelMap::kNumSlots * audio_tactile::kNumPwmValues;
+
+struct Result {
+    string preset;
+    string benchmark;
+    string unit;
+    double avg;
+    // cycle boundary, next_sample_frame only
+    double boundary_avg;
+    double boundary_max;
+    double max;
+};
+
+// keeps the compiler from dropping the measured work
+uint32_t g_sink;
+
+double ns_since(Clock::time_point t0)
+{
+    return chrono::duration<double, nano>(Clock::now() - t0).count();
+}
+
+SStream make_stream(const PresetStream& p)
+{
+    const Settings& s = p.settings;
+    SStream ss(ChannelMap(s.chan8), s.samplerate, s.stimfreq, s.stimduration, s.cycleperiod,
+	       s.pauzecycleperiod, s.pauzedcycles, s.jitter, p.volume(), /*test_mode=*/false);
+    ss.reset(1234);
+    return ss;
+}
+
+uint32_t frames_per_cycle(const PresetStream& p)
+{
+    return p.settings.samplerate * p.settings.cycleperiod / 1000 / SStream::samples_per_frame();
+}
+
+/*
+ * next_sample_frame(), in a batch for the average and call by call
+ * for the worst cases. Call n advances the stream to frame n + 1 of
+ * the cycle, frames 0 and 1 are the cycle boundary.
+ */
+Result bench_next_sample_frame(const PresetStream& p, uint32_t cycles)
+{
+    const uint32_t cycle_frames = frames_per_cycle(p);
+    const uint32_t frames = cycles * cycle_frames;
+
+    SStream ss = make_stream(p);
+    auto t0 = Clock::now();
+    for(uint32_t n = 0; n < frames; n++)
+	ss.next_sample_frame();
+    const double avg = ns_since(t0) / frames;
+    g_sink += ss.current_active_channel();
+
+    ss.reset(1234);
+    double boundary_sum = 0, boundary_max = 0, max = 0;
+    for(uint32_t n = 0; n < frames; n++) {
+	t0 = Clock::now();
+	ss.next_sample_frame();
+	const double ns = ns_since(t0);
+	if((n + 1) % cycle_frames <= 1) {
+	    boundary_sum += ns;
+	    boundary_max = std::max(boundary_max, ns);
+	} else
+	    max = std::max(max, ns);
+    }
+    g_sink += ss.current_active_channel();
+
+    return { p.name, "next_sample_frame", "ns/frame", avg, boundary_sum / (2 * cycles), boundary_max, max };
+}
+
+/*
+ * next_sample_frame() and set_chan_samples() in a batch, less the
+ * average of next_sample_frame()
+ */
+Result bench_set_chan_samples(const PresetStream& p, uint32_t frames, double next_sample_frame)
+{
+    SStream ss = make_stream(p);
+    vector<uint16_t> buffer(sequence_samples);
+
+    const auto t0 = Clock::now();
+    for(uint32_t n = 0; n < frames; n++) {
+	ss.next_sample_frame();
+	for(uint32_t chan = 0; chan < 8; chan++)
+	    ss.set_chan_samples(&buffer[order_pairs[chan]], chan);
+	g_sink += buffer[order_pairs[n % 8]];
+    }
+    return { p.name, "set_chan_samples", "ns/frame", ns_since(t0) / frames - next_sample_frame, 0, 0, 0 };
+}
+
+Result bench_render(const PresetStream& p, uint32_t frames)
+{
+    SStream ss = make_stream(p);
+    vector<uint16_t> buffer(sequence_samples);
+
+    const uint32_t sequences = frames / frames_per_sequence;
+    const auto t0 = Clock::now();
+    for(uint32_t n = 0; n < sequences; n++) {
+	ss.render(buffer.data(), frames_per_sequence);
+	g_sink += buffer[n % buffer.size()];
+    }
+    return { p.name, "render", "ns/frame", ns_since(t0) / (sequences * frames_per_sequence), 0, 0, 0 };
+}
+
+/*
+ * PwmTactor::SilenceChannel() of all 8 channels, once per sequence
+ */
+Result bench_silence_channel(const PresetStream& p, uint32_t frames)
+{
+    const uint16_t volume = p.volume();
+    vector<uint16_t> buffer(sequence_samples);
+
+    const uint32_t sequences = frames / frames_per_sequence;
+    const auto t0 = Clock::now();
+    for(uint32_t n = 0; n < sequences; n++) {
+	for(uint32_t chan = 0; chan < 8; chan++) {
+	    const auto slot = order_pairs[chan];
+	    uint16_t* dest = &buffer[slot / 4 * audio_tactile::kNumPwmValues * 4 + slot % 4];
+	    for(int i = 0; i < audio_tactile::kNumPwmValues; ++i)
+		dest[i * 4] = volume + n;
+	}
+	g_sink += buffer[n % buffer.size()];
+    }
+    return { p.name, "SilenceChannel", "ns/frame", ns_since(t0) / (sequences * frames_per_sequence), 0, 0, 0 };
+}
+
+/*
+ * SStream::shuffle_channel_order_()
+ */
+Result bench_shuffle(const PresetStream& p, uint32_t cycles)
+{
+    Random random(1234);
+    array<uint32_t, 8> order;
+    iota(order.begin(), order.end(), 0);
+
+    const auto t0 = Clock::now();
+    for(uint32_t n = 0; n < cycles; n++) {
+	random.shuffle(order.begin(), order.end());
+	g_sink += order[n % 8];
+    }
+    return { p.name, "shuffle_channel_order_", "ns/cycle", ns_since(t0) / cycles, 0, 0, 0 };
+}
+
+Result bench_get_sample(const PresetStream& p, uint32_t frames)
+{
+    const uint16_t volume = p.volume();
+    const SampleCache cache(p.settings.samplerate, p.settings.stimfreq);
+    const uint32_t period = p.settings.samplerate / p.settings.stimfreq;
+
+    uint32_t phase = 0, sum = 0;
+    const auto t0 = Clock::now();
+    for(uint32_t n = 0; n < frames; n++) {
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+	    sum += cache.get_sample(phase + i, volume);
+	phase += SStream::samples_per_frame();
+	if(phase >= period)
+	    phase -= period;
+    }
+    g_sink += sum;
+    return { p.name, "get_sample", "ns/frame", ns_since(t0) / frames, 0, 0, 0 };
+}
+
+string key(const string& preset, const string& benchmark)
+{
+    return preset + "/" + benchmark;
+}
+
+/*
+ * @return the streams of all presets in the presets file, none if it
+ * cannot be read
+ */
+vector<PresetStream> read_streams(const string& path)
+{
+    string json;
+    vector<Preset> presets;
+    vector<PresetStream> streams;
+    if(!read_file(path, &json) || !read_presets(json, &presets))
+	return streams;
+    for(const auto& preset : presets) {
+	PresetStream stream = { preset.at("name"), Settings(), 0 };
+	apply_preset(preset, &stream.settings, &stream.volume_percent);
+	streams.push_back(stream);
+    }
+    return streams;
+}
+
+/*
+ * Writes the results, one per line, so read_baseline() needs no JSON
+ * parser
+ */
+void write_json(ostream& out, const vector<Result>& results)
+{
+    out << "{\n"
+	<< "  \"pwm_frame_length\": " << audio_tactile::kNumPwmValues << ",\n"
+	<< "  \"dds\": " << audio_tactile::kSynthesis << ",\n"
+	<< "  \"results\": [\n";
+    for(size_t i = 0; i < results.size(); i++) {
+	const auto& r = results[i];
+	out << "    { \"preset\": \"" << r.preset << "\", \"benchmark\": \"" << r.benchmark
+	    << "\", \"unit\": \"" << r.unit << "\", \"avg\": " << r.avg;
+	if(r.benchmark == "next_sample_frame")
+	    out << ", \"boundary_avg\": " << r.boundary_avg << ", \"boundary_max\": " << r.boundary_max
+		<< ", \"max\": " << r.max;
+	out << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+string field(const string& line, const string& name)
+{
+    const string tag = "\"" + name + "\": ";
+    size_t pos = line.find(tag);
+    if(pos == string::npos)
+	return "";
+    pos += tag.size();
+    if(line[pos] == '"')
+	return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+bool read_baseline(const string& path, map<string, double>* baseline)
+{
+    ifstream in(path);
+    if(!in)
+	return false;
+    string line;
+    while(getline(in, line))
+	if(!field(line, "benchmark").empty())
+	    (*baseline)[key(field(line, "preset"), field(line, "benchmark"))] = atof(field(line, "avg").c_str());
+    return true;
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv)
+{
+    string json, baseline_file, presets_file = VHP_PRESETS;
+    double threshold = 20;
+    uint32_t cycles = 20;
+    uint32_t repeat = 5;
+
+    for(int i = 1; i + 1 < argc; i += 2) {
+	const string arg = argv[i];
+	if(arg == "--json")
+	    json = argv[i + 1];
+	else if(arg == "--presets")
+	    presets_file = argv[i + 1];
+	else if(arg == "--baseline")
+	    baseline_file = argv[i + 1];
+	else if(arg == "--threshold")
+	    threshold = atof(argv[i + 1]);
+	else if(arg == "--cycles")
+	    cycles = atoi(argv[i + 1]);
+	else if(arg == "--repeat")
+	    repeat = std::max(1, atoi(argv[i + 1]));
+	else {
+	    cerr << "usage: sstream-bench [--json <out>] [--baseline <json>] [--threshold <percent>] [--cycles <n>] [--repeat <n>] [--presets <file>]" << endl;
+	    return 1;
+	}
+    }
+
+    const vector<PresetStream> presets = read_streams(presets_file);
+    if(presets.empty()) {
+	cerr << "sstream-bench: no presets in " << presets_file << endl;
+	return 1;
+    }
+
+    vector<Result> results;
+    for(const auto& p : presets) {
+	const uint32_t frames = cycles * frames_per_cycle(p);
+	vector<Result> best;
+	for(uint32_t run = 0; run < repeat; run++) {
+	    const Result next = bench_next_sample_frame(p, cycles);
+	    const vector<Result> r = {
+		next,
+		bench_set_chan_samples(p, frames, next.avg),
+		bench_render(p, frames),
+		bench_silence_channel(p, frames),
+		bench_shuffle(p, frames),
+		bench_get_sample(p, frames),
+	    };
+	    if(best.empty())
+		best = r;
+	    for(size_t i = 0; i < r.size(); i++) {
+		best[i].avg = std::min(best[i].avg, r[i].avg);
+		best[i].boundary_avg = std::min(best[i].boundary_avg, r[i].boundary_avg);
+		best[i].boundary_max = std::min(best[i].boundary_max, r[i].boundary_max);
+		best[i].max = std::min(best[i].max, r[i].max);
+	    }
+	}
+	results.insert(results.end(), best.begin(), best.end());
+    }
+
+    for(const auto& r : results) {
+	cout << r.preset << "\t" << r.benchmark << "\t" << r.avg << " " << r.unit;
+	if(r.benchmark == "next_sample_frame")
+	    cout << ", cycle boundary " << r.boundary_avg << " avg " << r.boundary_max
+		 << " max, other frames " << r.max << " max";
+	cout << '\n';
+    }
+
+    if(!json.empty()) {
+	ofstream out(json);
+	write_json(out, results);
+	if(!out) {
+	    cerr << "sstream-bench: cannot write " << json << endl;
+	    return 1;
+	}
+    }
+
+    bool ok = true;
+    if(!baseline_file.empty()) {
+	map<string, double> baseline;
+	if(!read_baseline(baseline_file, &baseline)) {
+	    cerr << "sstream-bench: cannot read " << baseline_file << endl;
+	    return 1;
+	}
+	for(const auto& r : results) {
+	    const auto b = baseline.find(key(r.preset, r.benchmark));
+	    if(b == baseline.end() || b->second <= 0)
+		continue;
+	    const double change = (r.avg / b->second - 1) * 100;
+	    if(change > threshold) {
+		cout << "REGRESSION " << key(r.preset, r.benchmark) << ": " << b->second
+		     << " -> " << r.avg << " " << r.unit << " (+" << change << "%)" << endl;
+		ok = false;
+	    }
+	}
+	cout << (ok ? "no regressions" : "FAIL") << " against " << baseline_file << endl;
+    }
+
+    cerr << "(" << g_sink << ")" << endl;
+    return ok ? 0 : 1;
+}
@@ -64,7 +64,7 @@ public:
 bool test1() 
 {
     SStream ss(
-	g_settings.chan8,
+	ChannelMap(g_settings.chan8),
 	g_settings.samplerate,
 	g_settings.stimfreq,
 	g_settings.stimduration,
@@ -101,7 +101,7 @@ bool test1()
 		const auto samples_base = PwmTactor.GetChannel(channel);
 		cout << samples_base[sample] << ";";
 	    }
-	    cout << endl;
+	    cout << '\n';
 	}
     }
 	
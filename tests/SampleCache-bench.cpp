@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+#include "../VHP-Vibro-Glove2/src/SampleCache.hpp"
+
+using namespace std;
+
+/*
+ * Former float implementation of SampleCache, kept here as the
+ * reference for the fixed point version.
+ */
+class FloatSampleCache {
+public:
+    explicit FloatSampleCache(uint32_t samplerate, uint32_t stimfreq) :
+	samples_needed_(samplerate / stimfreq + 7),
+	cache_(samples_needed_)
+	{
+	    for(uint32_t i = 0; i < samples_needed_; i++) 
+		cache_[i] = std::sin (2 * pi() * i * stimfreq / samplerate);	
+	}
+
+    uint16_t get_sample(uint16_t i, uint16_t volume) const {
+	return (uint16_t) (volume + volume * cache_[i]);
+    }
+
+private:
+    const unsigned samples_needed_;    
+    std::vector<float> cache_;
+    
+    constexpr static float pi() { return std::atan(1)*4; }
+};
+
+
+/*
+ * Query the cache like SStream::set_chan_samples() does: 8 samples
+ * per frame, starting from a base that walks through one period.
+ */
+template<typename Cache>
+double bench(const Cache& cache, uint32_t period, uint16_t volume, uint32_t frames, uint32_t* checksum)
+{
+    uint16_t dest[8];
+    uint32_t sum = 0;
+    uint32_t base = 0;
+    
+    const auto t0 = chrono::steady_clock::now();
+    for(uint32_t n = 0; n < frames; n++) {
+	for(unsigned i = 0; i < 8; i++)
+	    dest[i] = cache.get_sample(base + i, volume);
+
+	sum += dest[n % 8];
+	base += 8;
+	if(base >= period)
+	    base -= period;
+    }
+    const auto t1 = chrono::steady_clock::now();
+
+    *checksum = sum;
+    return chrono::duration<double, nano>(t1 - t0).count() / (frames * 8.0);
+}
+
+
+/*
+ * As bench(), for the phase accumulator synthesis
+ */
+double bench_dds(const SampleCache& cache, uint32_t increment, uint16_t volume, uint32_t frames, uint32_t* checksum)
+{
+    uint16_t dest[8];
+    uint32_t sum = 0;
+    uint32_t phase = 0;
+    
+    const auto t0 = chrono::steady_clock::now();
+    for(uint32_t n = 0; n < frames; n++) {
+	for(unsigned i = 0; i < 8; i++)
+	    dest[i] = cache.get_dds_sample(phase + i * increment, volume);
+
+	sum += dest[n % 8];
+	phase += 8 * increment;
+    }
+    const auto t1 = chrono::steady_clock::now();
+
+    *checksum = sum;
+    return chrono::duration<double, nano>(t1 - t0).count() / (frames * 8.0);
+}
+
+
+int main() 
+{
+    const uint32_t samplerate = 46875;
+    const uint32_t stimfreqs[] = { 40, 250 };
+    const uint16_t volumes[] = { 77, 208, 278 };
+    const uint32_t frames = 10000000;
+    
+    for(auto stimfreq : stimfreqs) {
+	const FloatSampleCache f(samplerate, stimfreq);
+	const SampleCache q(samplerate, stimfreq);
+	const SampleCache dds(samplerate, stimfreq, SampleCache::kDds);
+	const SampleCache ddsi(samplerate, stimfreq, SampleCache::kDdsInterpolated);
+	const uint32_t increment = SampleCache::dds_increment(samplerate, stimfreq);
+	const uint32_t period = samplerate / stimfreq;
+
+	for(auto volume : volumes) {
+	    int max_diff = 0;
+	    for(uint32_t i = 0; i < period + 7; i++)
+		max_diff = max(max_diff, abs(f.get_sample(i, volume) - q.get_sample(i, volume)));
+
+	    uint32_t fsum, qsum, dsum, disum;
+	    const double fns = bench(f, period, volume, frames, &fsum);
+	    const double qns = bench(q, period, volume, frames, &qsum);
+	    const double dns = bench_dds(dds, increment, volume, frames, &dsum);
+	    const double dins = bench_dds(ddsi, increment, volume, frames, &disum);
+	    
+	    cout << "stimfreq " << stimfreq << " volume " << volume
+		 << " : float " << fns << " ns/sample, q15 " << qns << " ns/sample"
+		 << ", dds " << dns << " ns/sample, dds interpolated " << dins << " ns/sample"
+		 << ", max diff " << max_diff
+		 << " (" << fsum << "/" << qsum << "/" << dsum << "/" << disum << ")" << endl;
+	}
+    }
+    
+    return 0;
+}
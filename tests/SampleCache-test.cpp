@@ -13,24 +13,21 @@ int main()
     const int stimfreq = 250;
     const int volume = 128;
 
-    const SampleCache s(samplerate, stimfreq, volume);
+    const SampleCache s(samplerate, stimfreq);
 
 
     const uint16_t total_samples = samplerate / stimfreq;
 
     for(unsigned i = 0; i < total_samples; i++) {
-	const uint16_t* frame = s.cache_ + i;
-
 	cout << "I: " << i << " samples : ";
 	for(unsigned j = 0; j < 8; j++)
-	    cout << frame[j] << "-";
+	    cout << s.get_sample(i + j, volume) << "-";
 	cout << endl;
     }
 
-    const uint16_t* sil = s.silence_;
     cout << "Silence samples : ";
     for(unsigned j = 0; j < 8; j++)
-	cout << sil[j] << "-";
+	cout << volume << "-";
     cout << endl;
     
     
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the precomputed tables of SampleTables.hpp, generated by
+ * tools/gen-sample-tables.py, against the runtime computation of
+ * SampleCache, and that SampleCache picks them up.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include "VHP-Vibro-Glove2/src/SampleCache.hpp"
+
+using namespace std;
+
+int main() 
+{
+    bool ok = true;
+
+    for(const auto& table : kSampleTables) {
+	const uint32_t entries = table.samplerate / table.stimfreq + 7;
+	uint32_t differ = 0;
+	for(uint32_t i = 0; i < entries; i++) {
+	    const int diff = table.samples[i] - SampleCache::compute_entry(i, table.samplerate, table.stimfreq);
+	    // allow for differences of the host sinf()
+	    if(abs(diff) > 1)
+		ok = false;
+	    differ += diff != 0;
+	}
+	
+	const bool precomputed = SampleCache(table.samplerate, table.stimfreq).precomputed();
+	ok &= precomputed;
+	
+	cout << table.samplerate << " / " << table.stimfreq << ": " << entries << " entries, "
+	     << differ << " differ from runtime" << (precomputed ? "" : ", NOT USED") << endl;
+    }
+
+    if(SampleCache(46875, 123).precomputed()) {
+	cout << "46875 / 123 must be computed at runtime" << endl;
+	ok = false;
+    }
+    
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
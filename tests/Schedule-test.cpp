@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the cycle schedule of SStream against the per-sample math it
+ * replaced: a reference stream computes the active channel, the
+ * jittered onset, the end of the stimulation and the sine phase of
+ * every frame from its first sample number, as next_sample_frame()
+ * and set_chan_samples() did before the schedule. With the same seed
+ * both play the same samples, frame by frame and channel by channel:
+ *
+ * - shuffled and jittered, with pauzed cycles
+ * - a stimulation longer than its slot, cut at the slot end
+ * - test mode and a single channel
+ *
+ * The reference shuffles all 8 channels, so only 8 independent
+ * channels are compared.
+ */
+
+#include <iostream>
+#include <array>
+#include <numeric>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t samplerate = 46875;
+const uint16_t volume = 200;
+const uint32_t kChannels = 8;
+
+struct Params {
+    uint32_t stimfreq;
+    uint32_t stimduration;
+    uint32_t cycleperiod;
+    uint32_t pauzecycleperiod;
+    uint32_t pauzedcycles;
+    uint16_t jitter;
+    bool test_mode;
+    uint16_t single_channel;
+};
+
+/*
+ * The stream before the schedule, with the random draws of Random in
+ * the order SStream makes them
+ */
+class PerSampleStream {
+public:
+    PerSampleStream(const Params& p, uint32_t seed)
+	: p_(p), frame_counter_(0), cycle_counter_(0),
+	  max_jitter_(p.jitter * p.cycleperiod / kChannels / 1000),
+	  sample_cache_(samplerate, p.stimfreq), random_(seed) {
+	channel_jitter_.fill(0);
+	if(p.test_mode && p.single_channel > 0 && p.single_channel <= kChannels)
+	    channel_order_.fill(p.single_channel - 1);
+	else
+	    iota(channel_order_.begin(), channel_order_.end(), 0);
+
+	if(!p.test_mode)
+	    random_.shuffle(channel_order_.begin(), channel_order_.end());
+	if(max_jitter_ > 0)
+	    calc_channel_jitter_();
+    }
+
+    uint32_t current_active_channel() const {
+	if(cycle_is_pauzed_())
+	    return UINT32_MAX;
+	return channel_order_[frame_counter_ * SStream::samples_per_frame() / samples_per_slot_()];
+    }
+
+    void next_sample_frame() {
+	frame_counter_++;
+
+	if(frame_counter_ >= frames_per_cycle()) {
+	    frame_counter_ = 0;
+
+	    cycle_counter_++;
+	    if(cycle_counter_ >= p_.pauzecycleperiod)
+		cycle_counter_ = 0;
+
+	    if(!cycle_is_pauzed_()) {
+		if(!p_.test_mode)
+		    random_.shuffle(channel_order_.begin(), channel_order_.end());
+		if(max_jitter_ > 0)
+		    calc_channel_jitter_();
+	    }
+	}
+    }
+
+    void set_chan_samples(uint16_t* dest, uint32_t chan) const {
+	const int32_t first_sample = (int32_t) ((frame_counter_ * SStream::samples_per_frame())
+						% samples_per_slot_()) - channel_jitter_[chan];
+
+	if(first_sample < 0 ||
+	   first_sample > (int32_t) (p_.stimduration * samplerate / 1000)) {
+	    for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+		dest[i * SStream::kChannelsPerModule] = volume;
+	} else {
+	    const uint32_t base = first_sample % (samplerate / p_.stimfreq);
+	    for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+		dest[i * SStream::kChannelsPerModule] = sample_cache_.get_sample(base + i, volume);
+	}
+    }
+
+    uint32_t frames_per_cycle() const { return samples_per_cycle_() / SStream::samples_per_frame(); }
+
+private:
+    uint32_t samples_per_cycle_() const { return samplerate * p_.cycleperiod / 1000; }
+
+    uint32_t samples_per_slot_() const { return samples_per_cycle_() / kChannels; }
+
+    bool cycle_is_pauzed_() const { return cycle_counter_ >= p_.pauzecycleperiod - p_.pauzedcycles; }
+
+    void calc_channel_jitter_() {
+	for(auto& jitter : channel_jitter_)
+	    jitter = random_.below(max_jitter_);
+    }
+
+    const Params p_;
+    uint32_t frame_counter_;
+    uint32_t cycle_counter_;
+    const uint32_t max_jitter_;
+    const SampleCache sample_cache_;
+    Random random_;
+    array<uint32_t, kChannels> channel_order_;
+    array<int32_t, kChannels> channel_jitter_;
+};
+
+/*
+ * Plays `cycles` cycles of both streams as the sketch did before
+ * render(): a frame of the active channel, silence on the others
+ *
+ * @return false at the first frame that differs
+ */
+bool check_same(const Params& p, uint32_t seed, uint32_t cycles)
+{
+    SStream ss(ChannelMap(true), samplerate, p.stimfreq, p.stimduration, p.cycleperiod,
+	       p.pauzecycleperiod, p.pauzedcycles, p.jitter, volume, p.test_mode, p.single_channel);
+    ss.reset(seed);
+    PerSampleStream ref(p, seed);
+
+    const uint32_t frames = cycles * ref.frames_per_cycle();
+    uint32_t playing = 0;
+    for(uint32_t frame = 0; frame < frames; frame++) {
+	ss.next_sample_frame();
+	ref.next_sample_frame();
+	CHECK(ss.current_active_channel() == ref.current_active_channel());
+
+	const auto active = ss.current_active_channel();
+	for(uint32_t chan = 0; chan < kChannels; chan++) {
+	    uint16_t got[SStream::samples_per_frame() * SStream::kChannelsPerModule];
+	    uint16_t expected[SStream::samples_per_frame() * SStream::kChannelsPerModule];
+	    fill(got, got + sizeof(got) / sizeof(got[0]), volume);
+	    fill(expected, expected + sizeof(expected) / sizeof(expected[0]), volume);
+	    if(chan == active) {
+		ss.set_chan_samples(got, chan);
+		ref.set_chan_samples(expected, chan);
+	    }
+	    if(!equal(got, got + sizeof(got) / sizeof(got[0]), expected)) {
+		cout << "frame " << frame << " channel " << chan << " differs" << endl;
+		return false;
+	    }
+	    playing += chan == active && got[0] != volume;
+	}
+    }
+
+    // the streams stimulated at all
+    CHECK(playing > frames / 10);
+    return true;
+}
+
+int main()
+{
+    const Params params[] = {
+	// stimfreq, stimduration, cycleperiod, pauzecycleperiod, pauzedcycles,
+	// jitter, test_mode, single_channel
+	{ 250, 100, 1332, 5, 2, 235, false, 0 },
+	{ 40, 100, 666, 5, 2, 1000, false, 0 },
+	{ 250, 200, 1332, 3, 1, 500, false, 0 },
+	{ 250, 100, 1332, 5, 0, 0, true, 0 },
+	{ 100, 200, 666, 4, 1, 235, true, 3 },
+    };
+
+    bool ok = true;
+    for(const auto& p : params)
+	for(uint32_t seed : { 1u, 3456081u })
+	    ok &= check_same(p, seed, 7);
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
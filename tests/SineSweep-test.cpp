@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Sweeps the stimulation frequency over 1 .. 1000 Hz at the sample
+ * rates of the firmware and checks the sine of SampleCache::get_sample()
+ * without a precomputed table:
+ *
+ * - it is within kMaxError Q15 steps of the exact sine for every
+ *   sample of the period and the 7 samples of slack, indices past
+ *   65535 included
+ * - it uses no RAM, and a waveform at most kMaxWaveformEntries
+ *   entries at any frequency
+ * - it agrees with the precomputed tables of the presets
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "VHP-Vibro-Glove2/src/SampleCache.hpp"
+
+using namespace std;
+
+// rounding of the table entries, the interpolation between them and
+// the two shifts that round down, in Q15 steps of full scale, as for
+// kDdsInterpolated in Dds-test.cpp
+const double kMaxError = 3;
+// full scale, so the error is in Q15 steps
+const uint16_t volume = 32767;
+
+double error(const SampleCache& cache, uint32_t samplerate, uint32_t stimfreq, uint32_t i)
+{
+    const double exact = volume * (1 + sin(2 * M_PI * (double) i * stimfreq / samplerate));
+    return fabs(cache.get_sample(i, volume) - exact);
+}
+
+int main()
+{
+    bool ok = true;
+
+    for(uint32_t samplerate : { 15625, 46875, 93750 }) {
+	double max_error = 0;
+	uint32_t max_index = 0;
+	for(uint32_t stimfreq = 1; stimfreq <= 1000; stimfreq++) {
+	    const SampleCache cache(samplerate, stimfreq);
+	    if(cache.precomputed())
+		continue;
+	    ok &= cache.allocated() == 0;
+
+	    const uint32_t entries = samplerate / stimfreq + 7;
+	    for(uint32_t i = 0; i < entries; i++)
+		max_error = max(max_error, error(cache, samplerate, stimfreq, i));
+	    max_index = max(max_index, entries - 1);
+	}
+	cout << samplerate << " Hz: max error " << max_error << " up to index " << max_index << endl;
+	ok &= max_error <= kMaxError;
+    }
+
+    // a waveform table is bounded at any frequency
+    const vector<int16_t> square = { 32767, -32767 };
+    size_t waveform_bytes = 0;
+    for(uint32_t stimfreq = 1; stimfreq <= 1000; stimfreq++)
+	waveform_bytes = max(waveform_bytes, SampleCache(93750, stimfreq, SampleCache::kTable,
+							 square.data(), square.size()).allocated());
+    cout << "waveform: at most " << waveform_bytes << " bytes" << endl;
+    ok &= waveform_bytes <= SampleCache::kMaxWaveformEntries * sizeof(int16_t);
+
+    // the presets play as before: twice the sample rate and frequency
+    // is the same sine, without a precomputed table
+    for(const auto& table : kSampleTables) {
+	const SampleCache cache(table.samplerate, table.stimfreq);
+	const SampleCache computed(2 * table.samplerate, 2 * table.stimfreq);
+	ok &= cache.precomputed() && !computed.precomputed();
+	int max_diff = 0;
+	for(uint32_t i = 0; i < table.samplerate / table.stimfreq + 7; i++)
+	    max_diff = max(max_diff, abs(cache.get_sample(i, volume) - computed.get_sample(i, volume)));
+	cout << table.samplerate << " / " << table.stimfreq << ": max diff " << max_diff << endl;
+	ok &= max_diff <= 2;
+    }
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
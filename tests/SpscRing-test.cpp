@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks SpscRing with a producer and a consumer thread, as loop()
+ * and the PWM interrupt use it with VHP_RENDER_AHEAD:
+ *
+ * - entries arrive complete, in order and exactly once
+ * - the ring never holds more than its capacity
+ */
+
+#include <iostream>
+#include <thread>
+#include "VHP-Vibro-Glove2/src/SpscRing.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t kEntries = 1000000;
+const uint32_t kWords = 16;
+
+struct Entry {
+    uint32_t seq;
+    uint32_t words[kWords];
+};
+
+int main() 
+{
+    static SpscRing<Entry, 4> ring;
+
+    CHECK(ring.size() == 0 && ring.front() == nullptr);
+    for(uint32_t i = 0; i < ring.capacity(); i++) {
+	CHECK(ring.back() != nullptr);
+	ring.push();
+    }
+    CHECK(ring.back() == nullptr && ring.size() == ring.capacity());
+    while(ring.front())
+	ring.pop();
+    CHECK(ring.size() == 0);
+
+    thread producer([]() {
+	for(uint32_t seq = 0; seq < kEntries; ) {
+	    Entry* e = ring.back();
+	    if(!e) {
+		this_thread::yield();
+		continue;
+	    }
+	    e->seq = seq;
+	    for(uint32_t w = 0; w < kWords; w++)
+		e->words[w] = seq * kWords + w;
+	    ring.push();
+	    seq++;
+	}
+    });
+
+    uint32_t expected = 0, torn = 0, out_of_order = 0, overfull = 0;
+    while(expected < kEntries) {
+	if(ring.size() > ring.capacity())
+	    overfull++;
+	
+	const Entry* e = ring.front();
+	if(!e) {
+	    this_thread::yield();
+	    continue;
+	}
+	if(e->seq != expected)
+	    out_of_order++;
+	for(uint32_t w = 0; w < kWords; w++)
+	    if(e->words[w] != e->seq * kWords + w)
+		torn++;
+	ring.pop();
+	expected++;
+    }
+    producer.join();
+
+    cout << "entries: " << expected << " out of order: " << out_of_order
+	 << " torn: " << torn << " overfull: " << overfull << endl;
+    
+    CHECK(out_of_order == 0);
+    CHECK(torn == 0);
+    CHECK(overfull == 0);
+    CHECK(ring.front() == nullptr);
+    
+    cout << "PASS" << endl;
+    return 0;
+}
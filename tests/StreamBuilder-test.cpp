@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks StreamBuilder.hpp, the stream construction of
+ * PrepareStream() in VHP-Vibro-Glove2.ino:
+ *
+ * - the stream is placed in the given storage
+ * - the channel groups follow chan8, or the uploaded groups while
+ *   they are for the tactors of the map
+ * - a built stream renders
+ * - Settings::valid() rejects what SStream would divide by 0
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/StreamBuilder.hpp"
+#include "../VHP-Vibro-Glove2/src/Calibration.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+alignas(SStream) uint8_t g_storage[sizeof(SStream)];
+
+SStream* build(const Settings& settings, const TactorMap& tactor_map)
+{
+    const Calibration calibration;
+    return StreamBuilder::build(g_storage, settings, tactor_map, 200,
+				nullptr, 0, calibration.slot_gain, nullptr, 0);
+}
+
+int main()
+{
+    Settings settings;
+    TactorMap tactor_map;
+
+    CHECK(settings.valid());
+    for(uint32_t Settings::* setting : { &Settings::stimfreq, &Settings::cycleperiod,
+					 &Settings::pauzecycleperiod }) {
+	Settings invalid = settings;
+	invalid.*setting = 0;
+	CHECK(!invalid.valid());
+    }
+    Settings nyquist = settings;
+    nyquist.stimfreq = settings.samplerate / 2;
+    CHECK(nyquist.valid());
+    nyquist.stimfreq++;
+    CHECK(!nyquist.valid());
+
+    SStream* ss = build(settings, tactor_map);
+    CHECK((void*) ss == g_storage);
+    CHECK(ss->channels() == 8);
+    ss->~SStream();
+
+    settings.chan8 = false;
+    ss = build(settings, tactor_map);
+    CHECK(ss->channels() == 4);
+    ss->~SStream();
+
+    // groups for 10 tactors do not apply to the map of 8
+    const uint8_t groups[] = { 0, 1, 2, 3, 4, 0, 1, 2, 3, 4 };
+    settings.group_count = sizeof(groups);
+    copy(groups, groups + sizeof(groups), settings.groups);
+    ss = build(settings, tactor_map);
+    CHECK(ss->channels() == 4);
+    ss->~SStream();
+
+    const uint8_t slots[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    CHECK(tactor_map.set(slots, sizeof(slots)));
+    ss = build(settings, tactor_map);
+    CHECK(ss->channels() == 5);
+
+    render_sequences(*ss, 1);
+    ss->~SStream();
+
+    cout << "PASS" << endl;
+    return 0;
+}
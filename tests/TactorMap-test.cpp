@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the runtime tactor map of TactorMap.hpp:
+ *
+ * - a map with a slot out of range or used twice, or without 1 to 12
+ *   tactors, is rejected
+ * - the Pwm channel table follows SetChannelMap(), and slots dropped
+ *   from the map are silenced in both halves
+ * - SStream::render() plays every channel on its slot of the map
+ * - a tactor dropped from the map in the middle of its burst is
+ *   silenced in both halves once the stream of the new map takes over
+ * - Calibration::remap() moves the gains with the tactors, also to a
+ *   map with all 12 slots
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/PwmTactor.hpp"
+#include "../VHP-Vibro-Glove2/src/TactorMap.hpp"
+#include "test-util.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+const uint16_t volume = 200;
+
+/*
+ * Renders `sequences` PWM sequences of all modules, with unmapped
+ * slots left at 0
+ */
+vector<uint16_t> render(const uint16_t* order, uint32_t sequences)
+{
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(order, true), 46875, 250, 100, 1332, 5, 2, 235, volume, false);
+    return render_sequences(ss, sequences);
+}
+
+int main()
+{
+    TactorMap map;
+    CHECK(map.tactors == 8 && equal(map.order, map.order + map.tactors, order_pairs));
+
+    const uint8_t out_of_range[] = { 0, 1, 2, 3, 4, 5, 6, 12 };
+    const uint8_t twice[] = { 0, 1, 2, 3, 4, 5, 6, 0 };
+    const uint8_t all[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 11 };
+    CHECK(!map.set(out_of_range, 8));
+    CHECK(!map.set(twice, 8));
+    CHECK(!map.set(all, 0) && !map.set(all, 13));
+    CHECK(map.tactors == 8 && equal(map.order, map.order + map.tactors, order_pairs));
+
+    // tactors 0 and 7 swapped, tactor 3 moved from slot 7 to slot 0
+    const uint8_t rewired[] = { 11, 5, 6, 0, 8, 9, 10, 4 };
+    CHECK(map.set(rewired, 8));
+    CHECK(map.drives(0) && !map.drives(7));
+
+    // the channel table points where the map says, slot 7 is silenced
+    PwmTactor.Initialize(46875);
+    uint16_t* const buffer = PwmTactor.GetModulePointer(0);
+    CHECK(PwmTactor.GetChannelPointer(3) == buffer + kNumPwmValues * 4 + 7 % 4);
+    PwmTactor.SetChannelMap(map.order, map.tactors, volume);
+    CHECK(PwmTactor.GetNumChannels() == 8);
+    for(uint32_t channel = 0; channel < map.tactors; channel++) {
+	const uint32_t slot = map.order[channel];
+	CHECK(PwmTactor.GetChannelModule(channel) == (int) slot / 4);
+	CHECK(PwmTactor.GetChannelPointer(channel) ==
+	      buffer + slot / 4 * kNumPwmValues * 4 + slot % 4);
+    }
+    for(int half = 0; half < 2; half++)
+	CHECK(g_mock_pwm[1].seq[half].ptr[7 % 4] == volume);
+
+    // the stream plays channel c on slot order[c]
+    const uint32_t sequences = 46875 * 2 / (kFrames * SStream::samples_per_frame());
+    const auto reference = render(order_pairs, sequences);
+    const auto out = render(map.order, sequences);
+    for(uint32_t channel = 0; channel < map.tactors; channel++)
+	CHECK(slot_samples(out, map.order[channel]) == slot_samples(reference, order_pairs[channel]));
+    CHECK(slot_samples(out, 7) == vector<uint16_t>(slot_samples(out, 7).size(), 0));
+
+    // the last tactor plays to the end of the cycle, a stream of the
+    // first 7 takes over in the middle of its burst
+    uint8_t group[ChannelMap::kNumSlots];
+    ChannelMap::mirror_groups(group, 7, true);
+    SStream eight(ChannelMap(true), 46875, 250, 100, 666, 1, 0, 0, volume, true);
+    SStream seven(ChannelMap(order_pairs, group, 7), 46875, 250, 100, 666, 1, 0, 0, volume, true);
+    eight.reset(1);
+    vector<uint16_t> halves[2] = { vector<uint16_t>(kSequenceSamples, volume),
+				   vector<uint16_t>(kSequenceSamples, volume) };
+    const auto silent = [&](const vector<uint16_t>& half) {
+	const auto samples = slot_samples(half, order_pairs[7]);
+	return samples == vector<uint16_t>(samples.size(), volume);
+    };
+    SStream* stream = &eight;
+    bool burst = false;
+    uint32_t n = 0;
+    while(stream == &eight) {
+	auto& half = halves[n++ % 2];
+	stream = stream->render(half.data(), kFrames, &seven);
+	if(stream == &eight)
+	    burst = !silent(half);
+    }
+    CHECK(burst);
+    for(int i = 0; i < 2; i++)
+	stream->render(halves[n++ % 2].data(), kFrames);
+    CHECK(silent(halves[0]) && silent(halves[1]));
+
+    // the gains follow the tactors
+    Calibration calibration;
+    const TactorMap previous;
+    CHECK(calibration.set_tactor_gain(0, Calibration::kUnityGain / 2));
+    CHECK(calibration.set_tactor_gain(3, Calibration::kUnityGain / 4));
+    calibration.remap(previous, map);
+    CHECK(calibration.tactor_gain(0, map) == Calibration::kUnityGain / 2);
+    CHECK(calibration.tactor_gain(3, map) == Calibration::kUnityGain / 4);
+    CHECK(calibration.tactor_gain(7, map) == Calibration::kUnityGain);
+    CHECK(calibration.slot_gain[7] == Calibration::kUnityGain);
+
+    // all 12 slots with a tactor, the gains of the first 8 move along
+    TactorMap twelve;
+    CHECK(twelve.set(all, 12) && twelve.tactors == 12 && twelve.drives(7));
+    CHECK(!calibration.set_tactor_gain(11, Calibration::kUnityGain / 8, map));
+    calibration.remap(map, twelve);
+    CHECK(calibration.tactor_gain(0, twelve) == Calibration::kUnityGain / 2);
+    CHECK(calibration.tactor_gain(10, twelve) == Calibration::kUnityGain);
+    CHECK(calibration.set_tactor_gain(11, Calibration::kUnityGain / 8, twelve));
+    PwmTactor.SetChannelMap(twelve.order, twelve.tactors, volume);
+    CHECK(PwmTactor.GetNumChannels() == 12 && PwmTactor.GetChannelModule(11) == 2);
+
+    cout << "PASS" << endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks SStream::set_volume():
+ *
+ * - the level ramps monotonically and in small steps to the new
+ *   volume, and lands on it after kVolumeRampFrames frames
+ * - silent slots play the ramping level
+ * - after the ramp the stream plays as a stream built at the new
+ *   volume
+ * - a change during a ramp continues from the current level
+ * - reset() starts at the volume set, a stream taking over keeps the
+ *   level and ramp of the playing one
+ */
+
+#include <iostream>
+#include <vector>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace std;
+
+const uint32_t samplerate = 46875;
+
+SStream make_stream(uint32_t volume, uint32_t stimfreq = 250)
+{
+    return SStream(ChannelMap(true), samplerate, stimfreq, 100, 666, 5, 2, 235, volume, false, 0, 2);
+}
+
+/*
+ * Renders a single frame of all modules
+ */
+vector<uint16_t> render(SStream& stream, SStream* next = nullptr, SStream** playing = nullptr)
+{
+    vector<uint16_t> frame(ChannelMap::kNumModules * kFrameSamples);
+    SStream* p = stream.render(frame.data(), 1, next);
+    if(playing)
+	*playing = p;
+    return frame;
+}
+
+/*
+ * @return true if the tactors play level in frame, but for the one
+ * channel that may be stimulated
+ */
+bool silence_at(const vector<uint16_t>& frame, uint32_t level)
+{
+    uint32_t other = 0;
+    for(auto slot : order_pairs) {
+	const uint16_t* src = &frame[slot / 4 * kFrameSamples + slot % 4];
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++)
+	    if(src[i * 4] != level) {
+		other++;
+		break;
+	    }
+    }
+    return other <= 1;
+}
+
+bool check_ramp(uint32_t from, uint32_t to)
+{
+    SStream stream = make_stream(from), ref = make_stream(to);
+    stream.reset(3); ref.reset(3);
+
+    for(uint32_t f = 0; f < 100; f++) {
+	render(stream);
+	render(ref);
+    }
+
+    stream.set_volume(to);
+    CHECK(stream.volume() == from);
+    const uint32_t max_step = (max(from, to) - min(from, to)) / SStream::kVolumeRampFrames + 1;
+    uint32_t level = from;
+    for(uint32_t f = 0; f < SStream::kVolumeRampFrames; f++) {
+	const auto frame = render(stream);
+	render(ref);
+	const uint32_t now = stream.volume();
+	CHECK(from < to ? now >= level : now <= level);
+	CHECK(max(now, level) - min(now, level) <= max_step);
+	CHECK(silence_at(frame, now));
+	level = now;
+    }
+    CHECK(level == to);
+
+    // then plays as a stream at the new volume, a cycle and more
+    for(uint32_t f = 0; f < 5000; f++)
+	CHECK(render(stream) == render(ref));
+    return true;
+}
+
+bool check_reversal()
+{
+    SStream stream = make_stream(100);
+    stream.reset(1);
+    stream.set_volume(300);
+    for(uint32_t f = 0; f < SStream::kVolumeRampFrames / 2; f++)
+	render(stream);
+    const uint32_t level = stream.volume();
+    CHECK(level > 100 && level < 300);
+
+    // down again from where it is, no jump
+    stream.set_volume(50);
+    render(stream);
+    CHECK(stream.volume() < level && level - stream.volume() <= (level - 50) / SStream::kVolumeRampFrames + 1);
+    for(uint32_t f = 1; f < SStream::kVolumeRampFrames; f++)
+	render(stream);
+    CHECK(stream.volume() == 50);
+
+    // an unchanged volume does not ramp
+    stream.set_volume(50);
+    render(stream);
+    CHECK(stream.volume() == 50);
+    return true;
+}
+
+bool check_reset()
+{
+    SStream stream = make_stream(100), ref = make_stream(180);
+    stream.set_volume(180);
+    stream.reset(9); ref.reset(9);
+    CHECK(stream.volume() == 180);
+    for(uint32_t f = 0; f < 2000; f++)
+	CHECK(render(stream) == render(ref));
+    return true;
+}
+
+bool check_take_over()
+{
+    // b is built at the volume a started with
+    SStream a = make_stream(100), b = make_stream(100, 40);
+    a.reset(5); b.reset(5);
+    SStream* playing = &a;
+
+    // a cycle of 666 ms is 3902 frames, ramp over its end
+    for(uint32_t f = 0; f < 3902 - SStream::kVolumeRampFrames / 2; f++)
+	render(a);
+    a.set_volume(200);
+    uint32_t level = a.volume();
+    for(uint32_t f = 0; f < SStream::kVolumeRampFrames; f++) {
+	render(*playing, &b, &playing);
+	CHECK(playing->volume() >= level);
+	level = playing->volume();
+    }
+    CHECK(playing == &b);
+    CHECK(b.volume() == 200);
+    return true;
+}
+
+int main()
+{
+    bool ok = check_ramp(100, 200);
+    ok &= check_ramp(278, 0);
+    ok &= check_ramp(3, 4);
+    ok &= check_reversal();
+    ok &= check_reset();
+    ok &= check_take_over();
+
+    cout << (ok ? "PASS" : "FAIL") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Checks the user defined waveform:
+ *
+ * - upload in kWaveformChunk messages, validation by kWaveformCommit
+ * - a rejected upload keeps the active waveform
+ * - SampleCache resamples it, an uploaded sine plays like the sine
+ * - SStream plays an uploaded square wave
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/Message.hpp"
+#include "../VHP-Vibro-Glove2/src/WaveformUpload.hpp"
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "test-util.hpp"
+
+using namespace audio_tactile;
+using namespace std;
+
+/*
+ * Builds a message like f2heal_library.js writeMessage() does
+ */
+Message make_message(MessageType type, const vector<uint8_t>& payload)
+{
+    Message message;
+    message.data()[2] = static_cast<uint8_t>(type);
+    message.data()[3] = payload.size();
+    copy(payload.begin(), payload.end(), message.data() + Message::kHeaderSize);
+    message.SetBleHeader();
+    return message;
+}
+
+/*
+ * Uploads samples in chunks of 60, as the webui does, and commits
+ */
+bool upload(WaveformUpload& upload, const vector<int16_t>& samples, uint16_t checksum)
+{
+    for(size_t offset = 0; offset < samples.size(); offset += 60) {
+	vector<uint8_t> payload(2);
+	LittleEndianWriteU16(offset, payload.data());
+	for(size_t i = offset; i < min(samples.size(), offset + 60); i++) {
+	    payload.push_back(samples[i] & 0xff);
+	    payload.push_back((uint16_t) samples[i] >> 8);
+	}
+	
+	const Message message = make_message(MessageType::kWaveformChunk, payload);
+	uint16_t chunk_offset;
+	const uint8_t* data;
+	int bytes;
+	if(!message.ReadWaveformChunk(&chunk_offset, &data, &bytes) ||
+	   !upload.write_chunk(chunk_offset, data, bytes))
+	    return false;
+    }
+
+    vector<uint8_t> payload(4);
+    LittleEndianWriteU16(samples.size(), payload.data());
+    LittleEndianWriteU16(checksum, payload.data() + 2);
+    uint16_t size;
+    const Message message = make_message(MessageType::kWaveformCommit, payload);
+    return message.ReadWaveformCommit(&size, &checksum) && upload.commit(size, checksum);
+}
+
+int main() 
+{
+    const uint32_t samplerate = 46875;
+    const uint16_t volume = 2000;
+    
+    vector<int16_t> sine(100), square(64);
+    for(size_t i = 0; i < sine.size(); i++)
+	sine[i] = lround(32767 * sin(2 * M_PI * i / sine.size()));
+    for(size_t i = 0; i < square.size(); i++)
+	square[i] = i < square.size() / 2 ? 32767 : -32767;
+
+    WaveformUpload waveform;
+    CHECK(waveform.samples() == nullptr && waveform.size() == 0);
+
+    // bad checksum, the sine stays
+    CHECK(!upload(waveform, square, WaveformUpload::calc_checksum(square.data(), square.size()) ^ 1));
+    CHECK(waveform.size() == 0);
+    CHECK(upload(waveform, square, WaveformUpload::calc_checksum(square.data(), square.size())));
+    CHECK(waveform.size() == square.size() && waveform.samples()[0] == 32767);
+
+    // out of range chunk
+    const uint8_t two_bytes[2] = { 0 };
+    CHECK(!waveform.write_chunk(WaveformUpload::kMaxSamples, two_bytes, 2));
+    
+    // uploading another one keeps the active one until commit
+    const auto square_active = waveform.active();
+    CHECK(upload(waveform, sine, WaveformUpload::calc_checksum(sine.data(), sine.size())));
+    CHECK(waveform.size() == sine.size());
+    // a snapshot keeps its buffer and size over a commit
+    CHECK(square_active.size == square.size() && square_active.samples[0] == 32767);
+    const auto sine_active = waveform.active();
+    CHECK(sine_active.samples == waveform.samples() && sine_active.size == sine.size());
+    CHECK(waveform.commit(0, 0) && waveform.samples() == nullptr);
+
+    // an uploaded sine plays like the sine, from a table of the period
+    // or, at 10 Hz, interpolated at the phase
+    for(uint32_t stimfreq : { 10, 40, 250 }) {
+	const SampleCache cache(samplerate, stimfreq);
+	const SampleCache uploaded(samplerate, stimfreq, SampleCache::kTable, sine.data(), sine.size());
+	CHECK(uploaded.allocated() == (stimfreq == 10 ? (1 << kDdsTableBits) + 1 : samplerate / stimfreq + 7) * sizeof(int16_t));
+	int max_diff = 0;
+	for(uint32_t i = 0; i < samplerate / stimfreq + 7; i++)
+	    max_diff = max(max_diff, abs(cache.get_sample(i, volume) - uploaded.get_sample(i, volume)));
+	cout << stimfreq << " Hz uploaded sine: max diff " << max_diff << endl;
+	CHECK(max_diff <= 2);
+
+	const SampleCache dds(samplerate, stimfreq, SampleCache::kDds);
+	const SampleCache dds_uploaded(samplerate, stimfreq, SampleCache::kDds, sine.data(), sine.size());
+	max_diff = 0;
+	for(uint32_t phase = 0; phase < 0xff000000u; phase += 0x01000000u)
+	    max_diff = max(max_diff, abs(dds.get_dds_sample(phase, volume) - dds_uploaded.get_dds_sample(phase, volume)));
+	cout << stimfreq << " Hz uploaded sine, dds: max diff " << max_diff << endl;
+	CHECK(max_diff <= 2);
+    }
+
+    // square wave at 250 Hz: only silence, 0 and 2 * volume, except
+    // at the edges, interpolated over one waveform sample (~3 samples)
+    g_mock_micros = 12345;
+    SStream ss(ChannelMap(true), samplerate, 250, 100, 1332, 5, 2, 0, volume, true, 0, 0, square.data(), square.size());
+    uint16_t frame[SStream::samples_per_frame() * SStream::kChannelsPerModule];
+    uint32_t high = 0, low = 0, other = 0;
+    for(uint32_t n = 0; n < samplerate / SStream::samples_per_frame(); n++) {
+	ss.next_sample_frame();
+	ss.set_chan_samples(frame, ss.current_active_channel());
+	for(uint32_t i = 0; i < SStream::samples_per_frame(); i++) {
+	    const uint16_t s = frame[i * SStream::kChannelsPerModule];
+	    high += s == 2 * volume - 1;
+	    low += s == 0;
+	    other += s != 2 * volume - 1 && s != 0 && s != volume;
+	}
+    }
+    cout << "square: " << high << " high, " << low << " low, " << other << " edges" << endl;
+    CHECK(high > 0 && low > 0);
+    CHECK(other <= 2 * 4 * (high + low) / (samplerate / 250));
+    
+    cout << "PASS" << endl;
+    return 0;
+}
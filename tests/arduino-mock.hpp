@@ -6,13 +6,22 @@
 #include <stdlib.h>
 #include <chrono>
 
+// When non-zero, micros() returns this value. Tests set it to get
+// reproducible random seeds.
+unsigned long g_mock_micros = 0;
+
 unsigned long micros() 
 {
     using namespace std::chrono;
+
+    if(g_mock_micros)
+	return g_mock_micros;
     
     return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
 }
 
+// Cycle counter of IsrProfiler.hpp, set by tests
+unsigned long g_mock_cycles = 0;
 
 void randomSeed(unsigned long seed) 
 {
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * Host mock of the nRF52 PWM HAL, GPIO and NVIC functions used by
+ * PwmTactor.hpp.
+ *
+ * Each PWM module keeps its register state and simulates playback of
+ * SEQ0/SEQ1 including LOOP and the LOOPSDONE_SEQSTART0 shortcut. A
+ * test advances time with mock_pwm_step() and dispatches the IRQ
+ * handler of modules that have a pending, enabled event.
+ */
+
+#ifndef NRF_PWM_MOCK_H_
+#define NRF_PWM_MOCK_H_
+
+#include <stdint.h>
+#include <vector>
+
+enum nrf_pwm_clk_t {
+    NRF_PWM_CLK_16MHz = 0,
+    NRF_PWM_CLK_8MHz,
+    NRF_PWM_CLK_4MHz,
+    NRF_PWM_CLK_2MHz,
+    NRF_PWM_CLK_1MHz,
+    NRF_PWM_CLK_500kHz,
+    NRF_PWM_CLK_250kHz,
+    NRF_PWM_CLK_125kHz,
+};
+
+enum nrf_pwm_mode_t { NRF_PWM_MODE_UP, NRF_PWM_MODE_UP_AND_DOWN };
+enum nrf_pwm_dec_load_t { NRF_PWM_LOAD_COMMON, NRF_PWM_LOAD_GROUPED, NRF_PWM_LOAD_INDIVIDUAL, NRF_PWM_LOAD_WAVE_FORM };
+enum nrf_pwm_dec_step_t { NRF_PWM_STEP_AUTO, NRF_PWM_STEP_TRIGGERED };
+
+enum nrf_pwm_task_t {
+    NRF_PWM_TASK_STOP,
+    NRF_PWM_TASK_SEQSTART0,
+    NRF_PWM_TASK_SEQSTART1,
+    NRF_PWM_TASK_NEXTSTEP,
+};
+
+enum nrf_pwm_event_t {
+    NRF_PWM_EVENT_STOPPED,
+    NRF_PWM_EVENT_SEQSTARTED0,
+    NRF_PWM_EVENT_SEQSTARTED1,
+    NRF_PWM_EVENT_SEQEND0,
+    NRF_PWM_EVENT_SEQEND1,
+    NRF_PWM_EVENT_PWMPERIODEND,
+    NRF_PWM_EVENT_LOOPSDONE,
+    kMockPwmNumEvents,
+};
+
+enum {
+    NRF_PWM_INT_STOPPED_MASK = 1 << NRF_PWM_EVENT_STOPPED,
+    NRF_PWM_INT_SEQSTARTED0_MASK = 1 << NRF_PWM_EVENT_SEQSTARTED0,
+    NRF_PWM_INT_SEQSTARTED1_MASK = 1 << NRF_PWM_EVENT_SEQSTARTED1,
+    NRF_PWM_INT_SEQEND0_MASK = 1 << NRF_PWM_EVENT_SEQEND0,
+    NRF_PWM_INT_SEQEND1_MASK = 1 << NRF_PWM_EVENT_SEQEND1,
+    NRF_PWM_INT_PWMPERIODEND_MASK = 1 << NRF_PWM_EVENT_PWMPERIODEND,
+    NRF_PWM_INT_LOOPSDONE_MASK = 1 << NRF_PWM_EVENT_LOOPSDONE,
+};
+
+enum {
+    NRF_PWM_SHORT_SEQEND0_STOP_MASK = 1 << 0,
+    NRF_PWM_SHORT_SEQEND1_STOP_MASK = 1 << 1,
+    NRF_PWM_SHORT_LOOPSDONE_SEQSTART0_MASK = 1 << 2,
+    NRF_PWM_SHORT_LOOPSDONE_SEQSTART1_MASK = 1 << 3,
+    NRF_PWM_SHORT_LOOPSDONE_STOP_MASK = 1 << 4,
+};
+
+enum IRQn_Type { PWM0_IRQn = 28, PWM1_IRQn = 33, PWM2_IRQn = 34 };
+
+
+struct NRF_PWM_Type {
+    // registers
+    bool enabled = false;
+    uint32_t pins[4] = {0};
+    nrf_pwm_clk_t clock = NRF_PWM_CLK_16MHz;
+    uint16_t top = 0;
+    uint16_t loop = 0;
+    uint32_t shorts = 0;
+    uint32_t inten = 0;
+    struct {
+	const uint16_t* ptr = nullptr;
+	uint16_t cnt = 0;
+    } seq[2];
+    bool events[kMockPwmNumEvents] = {false};
+
+    // playback state
+    bool running = false;
+    int playing = 0;         // sequence being played
+    uint32_t position = 0;   // next value in the sequence
+    uint32_t loops_left = 0;
+    uint64_t started_at = 0; // tick of the last SEQSTART0 task
+    uint32_t starts = 0;     // number of SEQSTART tasks
+    std::vector<uint16_t> output[4];
+};
+
+NRF_PWM_Type g_mock_pwm[3];
+bool g_mock_nvic_enabled[3] = {false};
+uint64_t g_mock_ticks = 0;  // time in 16 MHz ticks
+
+#define NRF_PWM0 (&g_mock_pwm[0])
+#define NRF_PWM1 (&g_mock_pwm[1])
+#define NRF_PWM2 (&g_mock_pwm[2])
+
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+
+inline int mock_irq_module(IRQn_Type irq) {
+    return irq == PWM0_IRQn ? 0 : irq == PWM1_IRQn ? 1 : 2;
+}
+inline void NVIC_SetPriority(IRQn_Type, uint32_t) {}
+inline void NVIC_EnableIRQ(IRQn_Type irq) { g_mock_nvic_enabled[mock_irq_module(irq)] = true; }
+
+inline void nrf_gpio_cfg_output(uint32_t) {}
+inline void nrf_gpio_pin_write(uint32_t, uint32_t) {}
+
+inline void nrf_pwm_enable(NRF_PWM_Type* p) { p->enabled = true; }
+inline void nrf_pwm_pins_set(NRF_PWM_Type* p, uint32_t pins[4]) {
+    for(int i = 0; i < 4; i++) p->pins[i] = pins[i];
+}
+inline void nrf_pwm_configure(NRF_PWM_Type* p, nrf_pwm_clk_t clock, nrf_pwm_mode_t, uint16_t top) {
+    p->clock = clock;
+    p->top = top;
+}
+inline void nrf_pwm_seq_ptr_set(NRF_PWM_Type* p, uint8_t seq, const uint16_t* values) { p->seq[seq].ptr = values; }
+inline void nrf_pwm_seq_cnt_set(NRF_PWM_Type* p, uint8_t seq, uint16_t cnt) { p->seq[seq].cnt = cnt; }
+inline void nrf_pwm_seq_refresh_set(NRF_PWM_Type*, uint8_t, uint32_t) {}
+inline void nrf_pwm_seq_end_delay_set(NRF_PWM_Type*, uint8_t, uint32_t) {}
+inline void nrf_pwm_decoder_set(NRF_PWM_Type*, nrf_pwm_dec_load_t, nrf_pwm_dec_step_t) {}
+inline void nrf_pwm_loop_set(NRF_PWM_Type* p, uint16_t loop) { p->loop = loop; }
+inline void nrf_pwm_shorts_set(NRF_PWM_Type* p, uint32_t mask) { p->shorts = mask; }
+inline void nrf_pwm_int_enable(NRF_PWM_Type* p, uint32_t mask) { p->inten |= mask; }
+inline void nrf_pwm_int_disable(NRF_PWM_Type* p, uint32_t mask) { p->inten &= ~mask; }
+inline bool nrf_pwm_event_check(NRF_PWM_Type* p, nrf_pwm_event_t event) { return p->events[event]; }
+inline void nrf_pwm_event_clear(NRF_PWM_Type* p, nrf_pwm_event_t event) { p->events[event] = false; }
+
+inline void mock_pwm_start_seq(NRF_PWM_Type* p, int seq) {
+    p->running = true;
+    p->playing = seq;
+    p->position = 0;
+    p->events[seq ? NRF_PWM_EVENT_SEQSTARTED1 : NRF_PWM_EVENT_SEQSTARTED0] = true;
+}
+
+inline void nrf_pwm_task_trigger(NRF_PWM_Type* p, nrf_pwm_task_t task) {
+    switch(task) {
+    case NRF_PWM_TASK_SEQSTART0:
+	p->loops_left = p->loop;
+	p->started_at = g_mock_ticks;
+	p->starts++;
+	mock_pwm_start_seq(p, 0);
+	break;
+    case NRF_PWM_TASK_SEQSTART1:
+	p->loops_left = p->loop;
+	p->starts++;
+	mock_pwm_start_seq(p, 1);
+	break;
+    case NRF_PWM_TASK_STOP:
+	p->running = false;
+	p->events[NRF_PWM_EVENT_STOPPED] = true;
+	break;
+    default:
+	break;
+    }
+}
+
+/**
+ * @return number of 16 MHz ticks per PWM sample of the module
+ */
+inline uint32_t mock_pwm_period(const NRF_PWM_Type* p) {
+    return (uint32_t) p->top << p->clock;
+}
+
+/**
+ * Plays one PWM sample (4 values in individual decoder mode) and
+ * raises the events at the end of a sequence. Hardware shortcuts
+ * are applied right away.
+ */
+inline void mock_pwm_step(NRF_PWM_Type* p) {
+    if(!p->running)
+	return;
+
+    const auto& seq = p->seq[p->playing];
+    for(int ch = 0; ch < 4; ch++)
+	p->output[ch].push_back(seq.ptr[p->position + ch]);
+    p->position += 4;
+    
+    if(p->position < seq.cnt)
+	return;
+
+    p->events[p->playing ? NRF_PWM_EVENT_SEQEND1 : NRF_PWM_EVENT_SEQEND0] = true;
+    if(p->playing == 0 && p->loops_left > 0) {
+	mock_pwm_start_seq(p, 1);
+	return;
+    }
+    if(p->loops_left > 0)
+	p->loops_left--;
+    if(p->loops_left > 0) {
+	mock_pwm_start_seq(p, 0);
+	return;
+    }
+    
+    p->events[NRF_PWM_EVENT_LOOPSDONE] = true;
+    if(p->shorts & NRF_PWM_SHORT_LOOPSDONE_SEQSTART0_MASK) {
+	p->loops_left = p->loop;
+	mock_pwm_start_seq(p, 0);
+    } else {
+	p->running = false;
+	p->events[NRF_PWM_EVENT_STOPPED] = true;
+    }
+}
+
+/**
+ * @return true if the module would have its interrupt raised
+ */
+inline bool mock_pwm_irq_pending(int module) {
+    const NRF_PWM_Type* p = &g_mock_pwm[module];
+    if(!g_mock_nvic_enabled[module])
+	return false;
+    for(int event = 0; event < kMockPwmNumEvents; event++)
+	if(p->events[event] && (p->inten & (1u << event)))
+	    return true;
+    return false;
+}
+
+#endif
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#ifndef TEST_UTIL_HPP_
+#define TEST_UTIL_HPP_
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+/*
+ * Returned by a failing CHECK(): 1 from main(), false from a bool
+ * check_...() function
+ */
+struct TestFailed {
+    operator bool() const { return false; }
+    operator int() const { return 1; }
+};
+
+#define CHECK(cond) \
+    if(!(cond)) { std::cout << "FAIL line " << __LINE__ << ": " #cond << std::endl; return TestFailed(); }
+
+/*
+ * Rendering helpers, for tests that include SStream.hpp before this
+ * file. A PWM sequence is kFrames frames of every module, module after
+ * module, as SStream::render() writes it.
+ */
+#ifdef SSTREAM_HPP_
+
+const uint32_t kFrames = 4;
+const uint32_t kFrameSamples = SStream::samples_per_frame() * SStream::kChannelsPerModule;
+const uint32_t kModuleSamples = kFrames * kFrameSamples;
+const uint32_t kSequenceSamples = ChannelMap::kNumModules * kModuleSamples;
+
+/*
+ * Renders `sequences` PWM sequences of all modules into a buffer
+ * holding `fill`
+ */
+inline std::vector<uint16_t> render_sequences(SStream& ss, uint32_t sequences, uint16_t fill = 0)
+{
+    std::vector<uint16_t> out(sequences * kSequenceSamples, fill);
+    for(uint32_t n = 0; n < sequences; n++)
+	ss.render(&out[n * kSequenceSamples], kFrames);
+    return out;
+}
+
+/*
+ * @return PWM slot (module * 4 + channel) of sample index i of
+ * render_sequences()
+ */
+inline uint32_t slot_of(uint32_t i)
+{
+    const uint32_t module = i / kModuleSamples % ChannelMap::kNumModules;
+    return module * SStream::kChannelsPerModule + i % SStream::kChannelsPerModule;
+}
+
+/*
+ * @return the samples of PWM slot (module * 4 + channel) in
+ * render_sequences()
+ */
+inline std::vector<uint16_t> slot_samples(const std::vector<uint16_t>& out, uint32_t slot)
+{
+    std::vector<uint16_t> samples;
+    for(uint32_t i = 0; i < out.size(); i++)
+	if(slot_of(i) == slot)
+	    samples.push_back(out[i]);
+    return samples;
+}
+
+#endif
+
+#endif
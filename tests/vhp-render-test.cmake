@@ -0,0 +1,42 @@
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Renders every preset of webui/presets.json with vhp-render, checks
+# the output size and that a render is repeated exactly for its seed.
+#
+#   cmake -DRENDER=<vhp-render> -DPRESETS=<presets.json> -P vhp-render-test.cmake
+
+file(READ ${PRESETS} json)
+string(REGEX MATCHALL "\"name\": *\"[^\"]+\"" names "${json}")
+
+foreach(entry ${names})
+  string(REGEX REPLACE ".*\"([^\"]+)\"$" "\\1" name "${entry}")
+  foreach(run a b)
+    execute_process(COMMAND ${RENDER} --preset ${name} --presets ${PRESETS}
+      --seconds 2 --seed 1234 -o render-${name}-${run}.raw
+      RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "vhp-render --preset ${name} failed")
+    endif()
+  endforeach()
+
+  # 2 s of 8 channels of uint16 at 46875 Hz
+  file(SIZE render-${name}-a.raw size)
+  if(NOT size EQUAL 1500000)
+    message(FATAL_ERROR "preset ${name}: ${size} bytes rendered")
+  endif()
+
+  execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files
+    render-${name}-a.raw render-${name}-b.raw RESULT_VARIABLE differ)
+  if(differ)
+    message(FATAL_ERROR "preset ${name}: renders with the same seed differ")
+  endif()
+  message(STATUS "preset ${name}: OK")
+endforeach()
+
+execute_process(COMMAND ${RENDER} --preset 8-250 --presets ${PRESETS}
+  --seconds 1 --seed 1 -o render.wav RESULT_VARIABLE result)
+file(READ render.wav header LIMIT 4)
+file(SIZE render.wav size)
+if(NOT result EQUAL 0 OR NOT header STREQUAL "RIFF" OR NOT size EQUAL 750044)
+  message(FATAL_ERROR "wav render failed")
+endif()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: AGPL-3.0-or-later
+
+"""
+Generates VHP-Vibro-Glove2/src/SampleTables.hpp: a flash resident Q15
+sine table for every (samplerate, stimfreq) pair in webui/presets.json.
+SampleCache uses these tables instead of computing the sine at stream
+start. The header also holds the power of two sine table of the phase
+accumulator synthesis (VHP_DDS).
+
+The tables are computed as SampleCache::compute_entry(), in single
+precision. SampleCache::find_table_() looks them up by samplerate and
+stimfreq, and get_sample() indexes them by the sample in the period.
+Other pairs use the quarter of kDdsSineTable instead.
+
+    $ tools/gen-sample-tables.py           # regenerate the header
+    $ tools/gen-sample-tables.py --check   # fail if it is out of date
+"""
+
+import argparse
+import json
+import math
+import os
+import struct
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+PRESETS = os.path.join(ROOT, 'webui', 'presets.json')
+HEADER = os.path.join(ROOT, 'VHP-Vibro-Glove2', 'src', 'SampleTables.hpp')
+
+Q15_ONE = 32767
+# slack past the period, samplerate // stimfreq + 7 entries as a
+# waveform table of SampleCache, see its constructor
+SLACK = 7
+# log2 of the entries of the phase accumulator table
+DDS_TABLE_BITS = 10
+
+
+def f32(x):
+    return struct.unpack('f', struct.pack('f', x))[0]
+
+
+def lround(x):
+    return int(math.copysign(math.floor(abs(x) + 0.5), x))
+
+
+def sine_table(samplerate, stimfreq):
+    pi = f32(math.atan(1) * 4)
+    table = []
+    for i in range(samplerate // stimfreq + SLACK):
+        x = f32(2 * pi)
+        x = f32(x * i)
+        x = f32(x * stimfreq)
+        x = f32(x / samplerate)
+        table.append(lround(f32(Q15_ONE * f32(math.sin(x)))))
+    return table
+
+
+def dds_table():
+    # one guard entry for the interpolation of the last entry
+    size = 1 << DDS_TABLE_BITS
+    return [lround(Q15_ONE * math.sin(2 * math.pi * i / size)) for i in range(size + 1)]
+
+
+def table_lines(name, table):
+    out = ['const int16_t %s[%d] = {' % (name, len(table))]
+    for i in range(0, len(table), 12):
+        out.append('    ' + ', '.join('%d' % v for v in table[i:i + 12]) + ',')
+    out.append('};')
+    out.append('')
+    return out
+
+
+def preset_pairs(path):
+    with open(path) as f:
+        presets = json.load(f)['presets']
+    return sorted({(int(p['samplerate_hz']), int(p['stimulation_frequency_hz']))
+                   for p in presets})
+
+
+def header(pairs):
+    out = []
+    out.append('// SPDX-License-Identifier: AGPL-3.0-or-later')
+    out.append('')
+    out.append('// Generated by tools/gen-sample-tables.py from webui/presets.json,')
+    out.append('// do not edit.')
+    out.append('')
+    out.append('#include <stdint.h>')
+    out.append('')
+    out.append('#ifndef SAMPLETABLES_HPP_')
+    out.append('#define SAMPLETABLES_HPP_')
+    out.append('')
+    out.append('/**')
+    out.append(' * Precomputed Q15 sine of SampleCache for a (samplerate, stimfreq)')
+    out.append(' * pair, samplerate / stimfreq + 7 entries')
+    out.append(' */')
+    out.append('struct SampleTable {')
+    out.append('    uint32_t samplerate;')
+    out.append('    uint32_t stimfreq;')
+    out.append('    const int16_t* samples;')
+    out.append('};')
+    out.append('')
+
+    for samplerate, stimfreq in pairs:
+        out += table_lines('kSampleTable_%d_%d' % (samplerate, stimfreq),
+                           sine_table(samplerate, stimfreq))
+
+    out.append('const SampleTable kSampleTables[] = {')
+    for samplerate, stimfreq in pairs:
+        out.append('    { %d, %d, kSampleTable_%d_%d },'
+                   % (samplerate, stimfreq, samplerate, stimfreq))
+    out.append('};')
+    out.append('')
+    out.append('/**')
+    out.append(' * Q15 sine of 2^kDdsTableBits entries for a full period, for phase')
+    out.append(' * accumulator synthesis. The extra last entry equals the first.')
+    out.append(' */')
+    out.append('constexpr int kDdsTableBits = %d;' % DDS_TABLE_BITS)
+    out.append('')
+    out += table_lines('kDdsSineTable', dds_table())
+    out.append('#endif')
+    out.append('')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--check', action='store_true',
+                        help='only check that the header is up to date')
+    args = parser.parse_args()
+
+    text = header(preset_pairs(PRESETS))
+
+    if args.check:
+        with open(HEADER) as f:
+            if f.read() != text:
+                print('%s is out of date, run %s' % (HEADER, sys.argv[0]))
+                return 1
+        return 0
+
+    with open(HEADER, 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+#include <stdint.h>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../VHP-Vibro-Glove2/src/Settings.hpp"
+
+#ifndef PRESETS_HPP_
+#define PRESETS_HPP_
+
+/*
+ * Presets of webui/presets.json for the host tools, vhp-render and
+ * sstream-bench
+ */
+
+/*
+ * Preset as its keys and the text of their values
+ */
+using Preset = std::map<std::string, std::string>;
+
+inline bool read_file(const std::string& path, std::string* content)
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in)
+	return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    *content = ss.str();
+    return true;
+}
+
+/*
+ * Minimal reader of presets.json: an array "presets" of flat objects
+ * with string, number and boolean values. Values are returned as
+ * their text.
+ */
+inline bool read_presets(const std::string& json, std::vector<Preset>* presets)
+{
+    presets->clear();
+    size_t pos = 0;
+    auto skip_space = [&]() {
+	while(pos < json.size() && isspace((unsigned char) json[pos]))
+	    pos++;
+    };
+    auto read_string = [&](std::string* s) {
+	s->clear();
+	if(pos >= json.size() || json[pos] != '"')
+	    return false;
+	for(pos++; pos < json.size() && json[pos] != '"'; pos++) {
+	    if(json[pos] == '\\')
+		pos++;
+	    *s += json[pos];
+	}
+	pos++;
+	return true;
+    };
+
+    while((pos = json.find('{', pos)) != std::string::npos) {
+	Preset object;
+	pos++;
+	for(;;) {
+	    skip_space();
+	    std::string key, value;
+	    if(!read_string(&key))
+		break;
+	    skip_space();
+	    if(pos >= json.size() || json[pos++] != ':')
+		return false;
+	    skip_space();
+	    if(json[pos] == '"')
+		read_string(&value);
+	    else
+		while(pos < json.size() && json[pos] != ',' && json[pos] != '}' && !isspace((unsigned char) json[pos]))
+		    value += json[pos++];
+	    object[key] = value;
+	    skip_space();
+	    if(pos < json.size() && json[pos] == ',')
+		pos++;
+	}
+	if(object.count("name"))
+	    presets->push_back(object);
+    }
+    return true;
+}
+
+inline bool find_preset(const std::string& json, const std::string& name, Preset* preset)
+{
+    std::vector<Preset> presets;
+    if(!read_presets(json, &presets))
+	return false;
+    for(const auto& p : presets)
+	if(p.at("name") == name) {
+	    *preset = p;
+	    return true;
+	}
+    return false;
+}
+
+/*
+ * Applies a preset as applyPresetValues() in f2heal_webui.js does,
+ * so fractional values are truncated like the webui's messages
+ */
+inline void apply_preset(const Preset& preset, Settings* settings, uint32_t* volume)
+{
+    auto number = [&](const char* key, uint32_t fallback) -> uint32_t {
+	return preset.count(key) ? (uint32_t) atof(preset.at(key).c_str()) : fallback;
+    };
+
+    if(preset.count("8_channels"))
+	settings->chan8 = preset.at("8_channels") == "true";
+    settings->samplerate = number("samplerate_hz", settings->samplerate);
+    settings->stimfreq = number("stimulation_frequency_hz", settings->stimfreq);
+    settings->stimduration = number("stimulation_duration_ms", settings->stimduration);
+    settings->cycleperiod = number("cycle_period_duration_ms", settings->cycleperiod);
+    settings->pauzecycleperiod = number("number_of_cycles_in_pauze_cycle", settings->pauzecycleperiod);
+    settings->pauzedcycles = number("number_of_cycles_in_pauze_cycle_to_pauze", settings->pauzedcycles);
+    settings->jitter = number("jitter_on_timing_permill", settings->jitter);
+    *volume = number("volume_percent", *volume);
+}
+
+#endif
@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+
+/*
+ * vhp-render - renders the stimulation of the glove on the host
+ *
+ * Plays the settings, or a preset of webui/presets.json, through the
+ * real SStream and channel mapping, the way OnPwmSequenceEnd() does
+ * in sync mode, and writes the PWM levels of all tactors:
+ *
+ *   raw: uint16 little endian PWM levels, one frame of all channels
+ *        after the other, exactly as played
+ *   wav: 16 bit PCM, the deviation from the silence level scaled to
+ *        the PWM countertop (kTopValue is full scale)
+ *
+ *   $ vhp-render --preset 8-250 --seconds 60 -o 8-250.wav
+ *   $ vhp-render --stimfreq 40 --jitter 0 --seed 1 -o out.raw
+ *   $ vhp-render --tactors 0,1,2,3,4,5,6,7,8,9,10,11 \
+ *         --groups 0,1,2,3,4,5,5,4,3,2,1,0 -o 12-mirrored.wav
+ *
+ * The seed is printed, so a render with a new seed can be repeated.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include "../tests/arduino-mock.hpp"
+
+#include "../VHP-Vibro-Glove2/src/SStream.hpp"
+#include "../VHP-Vibro-Glove2/src/Settings.hpp"
+#include "../VHP-Vibro-Glove2/src/TactorMap.hpp"
+#include "../VHP-Vibro-Glove2/src/StreamBuilder.hpp"
+#include "../VHP-Vibro-Glove2/src/BoardDefs.hpp"
+#include "presets.hpp"
+
+using namespace std;
+
+#ifndef VHP_PRESETS
+#define VHP_PRESETS "webui/presets.json"
+#endif
+
+namespace {
+
+// PWM countertop of the default (not synchronized) clock, see PwmTactor.hpp
+constexpr uint32_t kTopValue = 512;
+// frames rendered per SStream::render() call
+constexpr uint32_t kFramesPerRender = 1024;
+
+void usage()
+{
+    cerr <<
+	"usage: vhp-render [options] -o <file.wav|file.raw>\n"
+	"\n"
+	"  --preset <name>         settings of a preset in the presets file\n"
+	"  --presets <file>        presets file, default " VHP_PRESETS "\n"
+	"  --seconds <n>           length of the render, default 10\n"
+	"  --format <wav|raw>      default from the file extension\n"
+	"  --slots                 write all 12 PWM slots instead of the tactors\n"
+	"  --tactors <s0,s1,..>    PWM slot of every tactor, default order_pairs\n"
+	"  --groups <c0,c1,..>     stream channel of every tactor, default from\n"
+	"                          --chan8, see ChannelMap.hpp\n"
+	"  --pattern <file>        play a binary pattern, see Pattern.hpp\n"
+	"\n"
+	"  settings, applied after the preset, defaults from Settings.hpp:\n"
+	"  --chan8 <0|1> --stimfreq <hz> --stimduration <ms> --cycleperiod <ms>\n"
+	"  --pauzecycleperiod <n> --pauzedcycles <n> --jitter <permill>\n"
+	"  --volume <percent> --test-mode <0|1> --single-channel <n>\n"
+	"  --rampduration <ms> --seed <n, 0 for a new seed> --samplerate <hz>\n";
+}
+
+void write_u16(vector<uint8_t>& out, uint16_t v)
+{
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+
+void write_u32(vector<uint8_t>& out, uint32_t v)
+{
+    write_u16(out, v & 0xffff);
+    write_u16(out, v >> 16);
+}
+
+vector<uint8_t> wav_header(uint32_t channels, uint32_t samplerate, uint64_t frames)
+{
+    const uint32_t data_size = frames * channels * 2;
+    vector<uint8_t> h;
+    h.insert(h.end(), { 'R', 'I', 'F', 'F' });
+    write_u32(h, 36 + data_size);
+    h.insert(h.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+    write_u32(h, 16);
+    write_u16(h, 1);  // PCM
+    write_u16(h, channels);
+    write_u32(h, samplerate);
+    write_u32(h, samplerate * channels * 2);
+    write_u16(h, channels * 2);
+    write_u16(h, 16);
+    h.insert(h.end(), { 'd', 'a', 't', 'a' });
+    write_u32(h, data_size);
+    return h;
+}
+
+/*
+ * Parses a comma separated list of numbers into values
+ *
+ * @return false if a value is not a number below 256 or there are
+ * more than TactorMap::kMaxTactors
+ */
+bool parse_list(const string& text, vector<uint8_t>* values)
+{
+    values->clear();
+    stringstream ss(text);
+    string item;
+    while(getline(ss, item, ',')) {
+	char* end;
+	const unsigned long v = strtoul(item.c_str(), &end, 0);
+	if(item.empty() || *end || v > 255 || values->size() == TactorMap::kMaxTactors)
+	    return false;
+	values->push_back(v);
+    }
+    return !values->empty();
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv)
+{
+    string preset_name, presets_file = VHP_PRESETS, output, format, pattern_file, tactors, groups;
+    double seconds = 10;
+    bool slots = false;
+    uint32_t volume = 25;  // g_volume of the firmware
+    map<string, string> settings;
+
+    for(int i = 1; i < argc; i++) {
+	const string arg = argv[i];
+	if(arg == "--slots") {
+	    slots = true;
+	    continue;
+	}
+	if(arg == "-h" || arg == "--help" || i + 1 >= argc || arg.compare(0, 1, "-")) {
+	    usage();
+	    return arg == "-h" || arg == "--help" ? 0 : 1;
+	}
+
+	const string value = argv[++i];
+	if(arg == "-o")
+	    output = value;
+	else if(arg == "--preset")
+	    preset_name = value;
+	else if(arg == "--presets")
+	    presets_file = value;
+	else if(arg == "--seconds")
+	    seconds = atof(value.c_str());
+	else if(arg == "--format")
+	    format = value;
+	else if(arg == "--pattern")
+	    pattern_file = value;
+	else if(arg == "--tactors")
+	    tactors = value;
+	else if(arg == "--groups")
+	    groups = value;
+	else
+	    settings[arg.substr(2)] = value;
+    }
+
+    if(output.empty()) {
+	usage();
+	return 1;
+    }
+    if(format.empty())
+	format = output.size() > 4 && output.compare(output.size() - 4, 4, ".wav") == 0 ? "wav" : "raw";
+    if(format != "wav" && format != "raw") {
+	cerr << "vhp-render: unknown format " << format << endl;
+	return 1;
+    }
+
+    if(!preset_name.empty()) {
+	string json;
+	Preset preset;
+	if(!read_file(presets_file, &json)) {
+	    cerr << "vhp-render: cannot read " << presets_file << endl;
+	    return 1;
+	}
+	if(!find_preset(json, preset_name, &preset)) {
+	    cerr << "vhp-render: preset " << preset_name << " not found in " << presets_file << endl;
+	    return 1;
+	}
+	apply_preset(preset, &g_settings, &volume);
+    }
+
+    for(const auto& s : settings) {
+	const uint32_t v = strtoul(s.second.c_str(), nullptr, 0);
+	if(s.first == "chan8") g_settings.chan8 = v;
+	else if(s.first == "samplerate") g_settings.samplerate = v;
+	else if(s.first == "stimfreq") g_settings.stimfreq = v;
+	else if(s.first == "stimduration") g_settings.stimduration = v;
+	else if(s.first == "cycleperiod") g_settings.cycleperiod = v;
+	else if(s.first == "pauzecycleperiod") g_settings.pauzecycleperiod = v;
+	else if(s.first == "pauzedcycles") g_settings.pauzedcycles = v;
+	else if(s.first == "jitter") g_settings.jitter = v;
+	else if(s.first == "volume") volume = v;
+	else if(s.first == "test-mode") g_settings.test_mode = v;
+	else if(s.first == "single-channel") g_settings.single_channel = v;
+	else if(s.first == "rampduration") g_settings.rampduration = v;
+	else if(s.first == "seed") g_settings.seed = v;
+	else {
+	    cerr << "vhp-render: unknown option --" << s.first << endl;
+	    usage();
+	    return 1;
+	}
+    }
+
+    if(!g_settings.valid()) {
+	cerr << "vhp-render: stimfreq must be 1 to samplerate / 2, cycleperiod and pauzecycleperiod above 0" << endl;
+	return 1;
+    }
+
+    string pattern;
+    if(!pattern_file.empty() && (!read_file(pattern_file, &pattern) ||
+				 !Pattern::valid((const uint8_t*) pattern.data(), pattern.size()))) {
+	cerr << "vhp-render: no valid pattern in " << pattern_file << endl;
+	return 1;
+    }
+
+    TactorMap tactor_map;
+    vector<uint8_t> list;
+    if(!tactors.empty() && !(parse_list(tactors, &list) && tactor_map.set(list.data(), list.size()))) {
+	cerr << "vhp-render: invalid tactors " << tactors << endl;
+	return 1;
+    }
+    if(!groups.empty()) {
+	if(!parse_list(groups, &list) || list.size() != tactor_map.tactors ||
+	   !ChannelMap::valid_groups(list.data(), list.size())) {
+	    cerr << "vhp-render: invalid groups " << groups << " for " << tactor_map.tactors << " tactors" << endl;
+	    return 1;
+	}
+	copy(list.begin(), list.end(), g_settings.groups);
+	g_settings.group_count = list.size();
+    }
+
+    // as VolumeLevel() in VHP-Vibro-Glove2.ino
+    const uint16_t level = volume * g_settings.vol_amplitude / 100;
+    // as PrepareStream() in VHP-Vibro-Glove2.ino, with the sine and
+    // unity gains
+    alignas(SStream) static uint8_t storage[sizeof(SStream)];
+    SStream& ss = *StreamBuilder::build(storage, g_settings, tactor_map, level,
+					nullptr, 0, nullptr,
+					pattern.empty() ? nullptr : (const uint8_t*) pattern.data(),
+					pattern.size());
+    const uint32_t seed = g_settings.seed ? g_settings.seed : micros();
+    ss.reset(seed);
+
+    const uint32_t channels = slots ? audio_tactile::kNumTotalPwm : tactor_map.tactors;
+    const uint32_t samples_per_render = kFramesPerRender * SStream::samples_per_frame();
+    const uint64_t samples = (uint64_t) (seconds * g_settings.samplerate);
+
+    const bool wav = format == "wav";
+    if(wav && samples * channels * 2 > UINT32_MAX - 36) {
+	cerr << "vhp-render: too long for a wav file, use raw" << endl;
+	return 1;
+    }
+
+    FILE* out = fopen(output.c_str(), "wb");
+    if(!out) {
+	cerr << "vhp-render: cannot write " << output << endl;
+	return 1;
+    }
+    static char out_buffer[1 << 16];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    if(wav) {
+	const auto header = wav_header(channels, g_settings.samplerate, samples);
+	fwrite(header.data(), 1, header.size(), out);
+    }
+
+    // PWM buffer of all modules, slots the stream does not drive stay silent
+    const uint32_t module_samples = samples_per_render * SStream::kChannelsPerModule;
+    vector<uint16_t> pwm(ChannelMap::kNumModules * module_samples, level);
+    vector<uint8_t> block(samples_per_render * channels * 2);
+
+    const auto t0 = chrono::steady_clock::now();
+    for(uint64_t done = 0; done < samples; done += samples_per_render) {
+	ss.render(pwm.data(), kFramesPerRender);
+
+	uint8_t* dest = block.data();
+	for(uint32_t i = 0; i < samples_per_render; i++)
+	    for(uint32_t c = 0; c < channels; c++) {
+		const uint32_t slot = slots ? c : tactor_map.order[c];
+		const uint16_t v = pwm[slot / 4 * module_samples + i * 4 + slot % 4];
+		const uint16_t w = wav ? (uint16_t) (((int32_t) v - level) * 32768 / (int32_t) kTopValue) : v;
+		*dest++ = w & 0xff;
+		*dest++ = w >> 8;
+	    }
+
+	const uint64_t n = min<uint64_t>(samples_per_render, samples - done);
+	fwrite(block.data(), 1, n * channels * 2, out);
+    }
+    const auto t1 = chrono::steady_clock::now();
+
+    if(fclose(out) != 0) {
+	cerr << "vhp-render: error writing " << output << endl;
+	return 1;
+    }
+
+    const double elapsed = chrono::duration<double>(t1 - t0).count();
+    cerr << "vhp-render: " << samples << " samples of " << channels << " channels, seed "
+	 << seed << ", " << seconds / elapsed << "x real time" << endl;
+    return 0;
+}
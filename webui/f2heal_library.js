@@ -21,6 +21,33 @@ const MESSAGE_TYPE_GET_VOLUME = 14;
 const MESSAGE_TYPE_SETTINGS_BATCH = 15;
 const MESSAGE_TYPE_GET_SETTINGS_BATCH = 16;
 const MESSAGE_TYPE_SINGLE_CHANNEL = 17;
+const MESSAGE_TYPE_RAMP_DURATION = 18;
+const MESSAGE_TYPE_WAVEFORM_CHUNK = 19;
+const MESSAGE_TYPE_WAVEFORM_COMMIT = 20;
+const MESSAGE_TYPE_TACTOR_GAIN = 21;
+const MESSAGE_TYPE_GET_TACTOR_GAINS = 22;
+const MESSAGE_TYPE_TACTOR_GAINS = 23;
+const MESSAGE_TYPE_SEED = 24;
+const MESSAGE_TYPE_PATTERN_CHUNK = 25;
+const MESSAGE_TYPE_PATTERN_COMMIT = 26;
+const MESSAGE_TYPE_GET_ISR_PROFILE = 27;
+const MESSAGE_TYPE_ISR_PROFILE = 28;
+const MESSAGE_TYPE_TACTOR_MAP = 29;
+const MESSAGE_TYPE_GET_TACTOR_MAP = 30;
+const MESSAGE_TYPE_CHANNEL_GROUPS = 31;
+
+/** Matches Calibration::kUnityGain, Q15 gain 1.0 */
+const TACTOR_UNITY_GAIN = 32768;
+
+/** Samples per kWaveformChunk message, fits the 128 byte payload. */
+const WAVEFORM_CHUNK_SAMPLES = 60;
+/** Matches WaveformUpload::kMaxSamples */
+const WAVEFORM_MAX_SAMPLES = 1024;
+/** Bytes per kPatternChunk message */
+const PATTERN_CHUNK_BYTES = 120;
+/** Matches Pattern::kMaxEvents */
+const PATTERN_MAX_EVENTS = 64;
+const PATTERN_WAVEFORMS = { sine: 0, uploaded: 1 };
 
 
 /** Function that does nothing, for use as a default UI function. */
@@ -29,6 +56,79 @@ function noOp() {
 }
 
 
+/**
+ * Fletcher-16 checksum, matches Fletcher16() in att/Serialize.hpp
+ *
+ * @param {!Uint8Array} bytes  Data to checksum.
+ * @param {number} init  Initial value, 1 for messages.
+ * @return {number} (sum2 << 8) | sum1
+ */
+function fletcher16(bytes, init=1) {
+    let sum1 = init & 0xff;
+    let sum2 = init >> 8;
+    for (let i = 0; i < bytes.length; i++) {
+	sum1 = (sum1 + bytes[i]) % 255;
+	sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
+
+
+/**
+ * Single period of a basic waveform, for uploadWaveform()
+ *
+ * @param {string} shape  'sine', 'square', 'triangle' or 'pulse' (25% duty cycle)
+ * @param {number} size  Number of samples.
+ * @return {!Int16Array} Q15 samples
+ */
+function makeWaveform(shape, size=256) {
+    let samples = new Int16Array(size);
+    for (let i = 0; i < size; i++) {
+	const x = i / size;
+	let v;
+	switch (shape) {
+	case 'square':   v = x < 0.5 ? 1 : -1; break;
+	case 'triangle': v = x < 0.25 ? 4 * x : x < 0.75 ? 2 - 4 * x : 4 * x - 4; break;
+	case 'pulse':    v = x < 0.25 ? 1 : -1; break;
+	default:         v = Math.sin(2 * Math.PI * x); break;
+	}
+	samples[i] = Math.round(32767 * v);
+    }
+    return samples;
+}
+
+
+/**
+ * Encodes a stimulation pattern for uploadPattern(), see Pattern.hpp
+ * for the format
+ *
+ * @param {number} period  Period in ms after which the pattern repeats.
+ * @param {!Array<!Object>} events  Events with channels (array of
+ *    channels 1-12), onset and duration (ms), amplitude (0-255, default
+ *    255) and waveform ('sine' or 'uploaded', default 'sine').
+ * @return {!Uint8Array} pattern
+ */
+function makePattern(period, events) {
+    let bytes = new Uint8Array(4 + 8 * events.length);
+    let view = new DataView(bytes.buffer);
+    view.setUint8(0, 1);
+    view.setUint8(1, events.length);
+    view.setUint16(2, period, /*littleEndian=*/true);
+    events.forEach((e, i) => {
+	const offset = 4 + 8 * i;
+	const mask = e.channels.reduce((mask, c) => mask | (1 << (c - 1)), 0);
+	view.setUint8(offset, mask & 0xff);
+	view.setUint8(offset + 1, e.amplitude ?? 255);
+	view.setUint8(offset + 2, PATTERN_WAVEFORMS[e.waveform ?? 'sine']);
+	// channels 9-12
+	view.setUint8(offset + 3, mask >> 8);
+	view.setUint16(offset + 4, e.onset, /*littleEndian=*/true);
+	view.setUint16(offset + 6, e.duration, /*littleEndian=*/true);
+    });
+    return bytes;
+}
+
+
 /**
  * Connects BLE to device that both has a name starting with 'Audio-to-Tactile'
  * and is advertising the Nordic UART Service, after user input.
@@ -113,12 +213,20 @@ class BleManager {
 		OnConnectionUIUpdate=noOp,
 		volumeUpdate=noOp,
 		onStreamUpdate=noOp,
-	       onSettingsBatch=noOp) {
+	       onSettingsBatch=noOp,
+	       onWaveformCommit=noOp,
+	       onTactorGains=noOp,
+	       onIsrProfile=noOp,
+	       onTactorMap=noOp) {
 	this.log = loggingFunction;
 	this.onConnectionUIUpdate = OnConnectionUIUpdate;
 	this.volumeUpdate = volumeUpdate;
 	this.onStreamUpdate = onStreamUpdate;
 	this.onSettingsBatch = onSettingsBatch;
+	this.onWaveformCommit = onWaveformCommit;
+	this.onTactorGains = onTactorGains;
+	this.onIsrProfile = onIsrProfile;
+	this.onTactorMap = onTactorMap;
 
 	this.bleDevice = null;
 	this.nusRx = null;
@@ -129,6 +237,12 @@ class BleManager {
 	this.a_running = false;
 	this.a_runningsince = 0;
 	this.a_battery = 0.0;
+	this.a_seed = 0;
+	// per PWM module, since the start of the stream
+	this.a_late_sequences = [0, 0, 0];
+	this.a_underruns = 0;
+	// duration of the PWM interrupt, see receiveIsrProfile()
+	this.a_isr_profile = null;
 
 	
 	// variables to hold settings
@@ -141,6 +255,14 @@ class BleManager {
 	this.s_jitter = 0;
 	this.s_single_channel = 0;
 	this.s_testmode = false;
+	this.s_rampduration = 0;
+	this.s_seed = 0;
+	this.s_tactor_gains = new Array(8).fill(TACTOR_UNITY_GAIN);
+	// PWM channel (0-11) of every tactor, see receiveTactorMap()
+	this.s_tactor_map = [4, 5, 6, 7, 8, 9, 10, 11];
+	// stream channel (0-11) of every tactor, empty for the default
+	// groups of 8 channel mode, see setChannelGroups()
+	this.s_channel_groups = [];
     }
 
     /** Toggle the BLE connection. */
@@ -188,7 +310,10 @@ class BleManager {
 	let value = new Uint8Array(messagePayload.buffer);
 	this.volumeUpdate(value[0]);
 
-	this.requestStatusBatch();
+	// one write at a time, the next request when this one is sent
+	Promise.resolve(this.requestStatusBatch())
+	    .then(() => this.requestTactorGains())
+	    .then(() => this.requestTactorMap());
     }
     
     /**
@@ -229,6 +354,20 @@ class BleManager {
 	let view_sc = new DataView(messagePayload.buffer, 26, 4);
 	this.s_single_channel = view_sc.getUint32(0, /*littleEndian=*/true);
 
+	// not sent by older firmware
+	if(messagePayload.byteLength >= 34) {
+	    let view_rd = new DataView(messagePayload.buffer, 30, 4);
+	    this.s_rampduration = view_rd.getUint32(0, /*littleEndian=*/true);
+	}
+	if(messagePayload.byteLength >= 38) {
+	    let view_seed = new DataView(messagePayload.buffer, 34, 4);
+	    this.s_seed = view_seed.getUint32(0, /*littleEndian=*/true);
+	}
+	if(messagePayload.byteLength >= 39) {
+	    const count = messagePayload[38];
+	    this.s_channel_groups = Array.from(messagePayload.slice(39, 39 + count));
+	}
+
 	this.onSettingsBatch();
 	
 	this.log(" Settings 8chan: " + this.s_chan8
@@ -239,7 +378,10 @@ class BleManager {
 		 + ", pauzedcycles: " + this.s_pauzedcycles
 		 + ", jitter: " + this.s_jitter
 		 + ", single_channel: " + this.s_single_channel
-		 + ", testmode: " + this.s_testmode);
+		 + ", testmode: " + this.s_testmode
+		 + ", rampduration: " + this.s_rampduration
+		 + ", seed: " + this.s_seed
+		 + ", channel groups: " + this.s_channel_groups.join(', '));
 
 
 
@@ -268,15 +410,116 @@ class BleManager {
 	let view_battery = new DataView(messagePayload.buffer, 9, 4);
 	this.a_battery = view_battery.getFloat32(0, /*littleEndian=*/true);
 
+	// not sent by older firmware
+	if(messagePayload.byteLength >= 17) {
+	    let view_seed = new DataView(messagePayload.buffer, 13, 4);
+	    this.a_seed = view_seed.getUint32(0, /*littleEndian=*/true);
+	}
+	if(messagePayload.byteLength >= 33) {
+	    let view_late = new DataView(messagePayload.buffer, 17, 16);
+	    for (let module = 0; module < 3; module++) {
+		this.a_late_sequences[module] = view_late.getUint32(4 * module, /*littleEndian=*/true);
+	    }
+	    this.a_underruns = view_late.getUint32(12, /*littleEndian=*/true);
+	}
+
 	this.onStreamUpdate();
 
 	this.log(" Status running: " + this.a_running
 		 + ", runningsince: " + this.a_runningsince
-		 + ", battery: " + this.a_battery);
+		 + ", battery: " + this.a_battery
+		 + ", seed: " + this.a_seed
+		 + ", late sequences: " + this.a_late_sequences.join('/')
+		 + ", underruns: " + this.a_underruns);
 
 
     }
     
+    /**
+     * Handles the reply to a waveform upload
+     *
+     * Matches the function Message::WriteWaveformCommit()
+     */
+    receiveWaveformCommit(messagePayload) {
+	let view = new DataView(messagePayload.buffer);
+	const ok = view.getUint8(0) == 1;
+	const samples = view.getUint16(1, /*littleEndian=*/true);
+	this.log("Waveform " + (ok ? "accepted" : "rejected")
+		 + ", active waveform: " + (samples ? samples + " samples" : "sine"));
+	this.onWaveformCommit(ok, samples);
+    }
+
+    /**
+     * Handles the reply to a pattern upload
+     *
+     * Matches the function Message::WritePatternCommit()
+     */
+    receivePatternCommit(messagePayload) {
+	let view = new DataView(messagePayload.buffer);
+	const ok = view.getUint8(0) == 1;
+	const size = view.getUint16(1, /*littleEndian=*/true);
+	this.log("Pattern " + (ok ? "accepted" : "rejected")
+		 + ", active pattern: " + (size ? size + " bytes" : "none"));
+    }
+
+    /**
+     * Handles the tactor gains message from the device
+     *
+     * Matches the function Message::WriteTactorGains()
+     */
+    receiveTactorGains(messagePayload) {
+	let view = new DataView(messagePayload.buffer);
+	this.s_tactor_gains = new Array(messagePayload.byteLength >> 1);
+	for (let tactor = 0; tactor < this.s_tactor_gains.length; tactor++) {
+	    this.s_tactor_gains[tactor] = view.getUint16(2 * tactor, /*littleEndian=*/true);
+	}
+	this.log("Tactor gains: " + this.s_tactor_gains.join(', '));
+	this.onTactorGains();
+    }
+
+    /**
+     * Handles the tactor map message from the device, the reply to
+     * both setTactorMap() and requestTactorMap()
+     *
+     * Matches the function Message::WriteTactorMap()
+     */
+    receiveTactorMap(messagePayload) {
+	const ok = messagePayload[0] == 1;
+	this.s_tactor_map = Array.from(messagePayload.slice(1));
+	this.log("Tactor map " + (ok ? "" : "rejected, active map ") + this.s_tactor_map.join(', '));
+	this.onTactorMap();
+    }
+
+    /**
+     * Handles the profile of the PWM interrupt. Cycle counts are
+     * converted to microseconds.
+     *
+     * Matches the function Message::WriteIsrProfile()
+     */
+    receiveIsrProfile(messagePayload) {
+	let view = new DataView(messagePayload.buffer);
+	const u32 = (i) => view.getUint32(4 * i, /*littleEndian=*/true);
+	const us = (cycles) => cycles * 1e6 / u32(7);
+
+	this.a_isr_profile = {
+	    count: u32(0),
+	    min_us: us(u32(1)),
+	    avg_us: us(u32(2)),
+	    max_us: us(u32(3)),
+	    gap_min_us: us(u32(4)),
+	    gap_avg_us: us(u32(5)),
+	    gap_max_us: us(u32(6)),
+	    // buckets of log2 cycles, see IsrProfiler.hpp
+	    histogram: Array.from({ length: (messagePayload.byteLength - 32) / 4 }, (_, b) => u32(8 + b)),
+	};
+	const p = this.a_isr_profile;
+	this.log("ISR profile: " + p.count + " calls, "
+		 + p.min_us.toFixed(1) + " / " + p.avg_us.toFixed(1) + " / " + p.max_us.toFixed(1)
+		 + " us, gap " + p.gap_min_us.toFixed(1) + " / " + p.gap_avg_us.toFixed(1)
+		 + " / " + p.gap_max_us.toFixed(1) + " us");
+	this.onIsrProfile();
+    }
+
     /**
      * Send a request to the device for the current Volume
      */
@@ -298,7 +541,82 @@ class BleManager {
     requestStatusBatch() {
 	if(!this.connected) { return; }
 	this.log("Request Get Status Batch");
-	this.writeMessage(MESSAGE_TYPE_GET_STATUS_BATCH, new Uint8Array(0));
+	return this.writeMessage(MESSAGE_TYPE_GET_STATUS_BATCH, new Uint8Array(0));
+    }
+
+    /**
+     * Send a request for the profile of the PWM interrupt
+     *
+     * @param {boolean} reset  Restart the profile after it is sent.
+     */
+    requestIsrProfile(reset=false) {
+	if(!this.connected) { return; }
+	this.log("Request ISR Profile" + (reset ? " and reset" : ""));
+	return this.writeMessage(MESSAGE_TYPE_GET_ISR_PROFILE, new Uint8Array([reset ? 1 : 0]));
+    }
+
+    /**
+     * Send a request for the tactor gains to the device
+     */
+    requestTactorGains() {
+	if(!this.connected) { return; }
+	this.log("Request Get Tactor Gains");
+	return this.writeMessage(MESSAGE_TYPE_GET_TACTOR_GAINS, new Uint8Array(0));
+    }
+
+    /**
+     * Send a request for the tactor map to the device
+     */
+    requestTactorMap() {
+	if(!this.connected) { return; }
+	this.log("Request Get Tactor Map");
+	return this.writeMessage(MESSAGE_TYPE_GET_TACTOR_MAP, new Uint8Array(0));
+    }
+
+    /**
+     * Send the PWM channel every tactor is wired to, the device
+     * stores the map in flash. The calibration gains move with the
+     * tactors.
+     *
+     * @param {number[]} slots  PWM channel 0-11 of every tactor, 1
+     *     to 12 tactors, all different.
+     */
+    setTactorMap(slots) {
+	if(!this.connected) { return; }
+	this.log("Set tactor map to: " + slots.join(', '));
+	return this.writeMessage(MESSAGE_TYPE_TACTOR_MAP, new Uint8Array(slots));
+    }
+
+    /**
+     * Send the stream channel every tactor plays, tactors sharing a
+     * channel vibrate together. The channels used must be 0 to n-1
+     * without gaps, and there must be a group for every tactor of the
+     * tactor map, otherwise the 8 channel setting selects the groups.
+     *
+     * @param {number[]} groups  Stream channel 0-11 of every tactor,
+     *     empty for the default groups.
+     */
+    setChannelGroups(groups) {
+	if(!this.connected) { return; }
+	this.log("Set channel groups to: " + groups.join(', '));
+	return this.writeMessage(MESSAGE_TYPE_CHANNEL_GROUPS, new Uint8Array(groups));
+    }
+
+    /**
+     * Send the calibration gain of a tactor, the device stores it in
+     * flash
+     *
+     * @param {number} tactor  Tactor 0-11.
+     * @param {number} gain  Q15 gain, 0 to TACTOR_UNITY_GAIN.
+     */
+    setTactorGain(tactor, gain) {
+	if(!this.connected) { return; }
+	this.log("Set tactor " + tactor + " gain to: " + gain);
+	let payload = new Uint8Array(3);
+	let view = new DataView(payload.buffer);
+	view.setUint8(0, tactor);
+	view.setUint16(1, gain, /*littleEndian=*/true);
+	return this.writeMessage(MESSAGE_TYPE_TACTOR_GAIN, payload);
     }
 
 	
@@ -340,6 +658,69 @@ class BleManager {
     }
     
     
+    /**
+     * Uploads a single period waveform, played instead of the sine
+     * from the next stream start. An empty array returns to the sine.
+     *
+     * @param {!Int16Array} samples  Q15 samples, at most WAVEFORM_MAX_SAMPLES.
+     */
+    async uploadWaveform(samples) {
+	if(!this.connected) { return; }
+	if(samples.length > WAVEFORM_MAX_SAMPLES) {
+	    this.log("Waveform too long: " + samples.length + " samples");
+	    return;
+	}
+	this.log("Upload waveform of " + samples.length + " samples");
+
+	let bytes = new Uint8Array(2 * samples.length);
+	let view = new DataView(bytes.buffer);
+	samples.forEach((v, i) => view.setInt16(2 * i, v, /*littleEndian=*/true));
+	
+	for (let offset = 0; offset < samples.length; offset += WAVEFORM_CHUNK_SAMPLES) {
+	    const chunk = bytes.subarray(2 * offset, 2 * (offset + WAVEFORM_CHUNK_SAMPLES));
+	    let payload = new Uint8Array(2 + chunk.length);
+	    new DataView(payload.buffer).setUint16(0, offset, /*littleEndian=*/true);
+	    payload.set(chunk, 2);
+	    await this.writeMessage(MESSAGE_TYPE_WAVEFORM_CHUNK, payload);
+	}
+
+	let commit = new Uint8Array(4);
+	let commit_view = new DataView(commit.buffer);
+	commit_view.setUint16(0, samples.length, /*littleEndian=*/true);
+	commit_view.setUint16(2, fletcher16(bytes), /*littleEndian=*/true);
+	await this.writeMessage(MESSAGE_TYPE_WAVEFORM_COMMIT, commit);
+    }
+    
+    /**
+     * Uploads a stimulation pattern, played instead of the shuffled
+     * bursts from the next stream start. An empty array returns to
+     * the bursts.
+     *
+     * @param {!Uint8Array} pattern  Pattern from makePattern().
+     */
+    async uploadPattern(pattern) {
+	if(!this.connected) { return; }
+	if(pattern.length > 4 + 8 * PATTERN_MAX_EVENTS) {
+	    this.log("Pattern too long: " + pattern.length + " bytes");
+	    return;
+	}
+	this.log("Upload pattern of " + pattern.length + " bytes");
+
+	for (let offset = 0; offset < pattern.length; offset += PATTERN_CHUNK_BYTES) {
+	    const chunk = pattern.subarray(offset, offset + PATTERN_CHUNK_BYTES);
+	    let payload = new Uint8Array(2 + chunk.length);
+	    new DataView(payload.buffer).setUint16(0, offset, /*littleEndian=*/true);
+	    payload.set(chunk, 2);
+	    await this.writeMessage(MESSAGE_TYPE_PATTERN_CHUNK, payload);
+	}
+
+	let commit = new Uint8Array(4);
+	let commit_view = new DataView(commit.buffer);
+	commit_view.setUint16(0, pattern.length, /*littleEndian=*/true);
+	commit_view.setUint16(2, fletcher16(pattern), /*littleEndian=*/true);
+	await this.writeMessage(MESSAGE_TYPE_PATTERN_COMMIT, commit);
+    }
+    
     /**
      * Handles a new BLE message from the device by parsing message type and
      * calling the appropriate handler.
@@ -368,6 +749,21 @@ class BleManager {
 	case MESSAGE_TYPE_STATUS_BATCH:
 	    this.receiveStatusBatch(messagePayload);
 	    break;
+	case MESSAGE_TYPE_WAVEFORM_COMMIT:
+	    this.receiveWaveformCommit(messagePayload);
+	    break;
+	case MESSAGE_TYPE_TACTOR_GAINS:
+	    this.receiveTactorGains(messagePayload);
+	    break;
+	case MESSAGE_TYPE_PATTERN_COMMIT:
+	    this.receivePatternCommit(messagePayload);
+	    break;
+	case MESSAGE_TYPE_ISR_PROFILE:
+	    this.receiveIsrProfile(messagePayload);
+	    break;
+	case MESSAGE_TYPE_TACTOR_MAP:
+	    this.receiveTactorMap(messagePayload);
+	    break;
 	default:
 	    this.log('Unsupported message type.');
 	}
@@ -377,6 +773,7 @@ class BleManager {
      * Writes a message to the device.
      * @param {number} messageType Code indicating the message type.
      * @param {!Uint8Array} messagePayload Contents to send to device.
+     * @return {!Promise} Resolves when the message is written.
      * @private
      */
     writeMessage(messageType, messagePayload) {
@@ -390,15 +787,10 @@ class BleManager {
 	    bytes[4 + i] = messagePayload[i];
 	}
 	// Compute Fletcher-16 checksum.
-	let sum1 = 1;
-	let sum2 = 0;
-	for (let i = 2; i < bytes.length; i++) {
-	    sum1 += bytes[i];
-	    sum2 += sum1;
-	}
-	bytes[0] = sum1 % 255;
-	bytes[1] = sum2 % 255;
-	this.nusRx.writeValue(bytes);
+	const checksum = fletcher16(bytes.subarray(2));
+	bytes[0] = checksum & 0xff;
+	bytes[1] = checksum >> 8;
+	return this.nusRx.writeValue(bytes);
     }
 }
 
@@ -142,6 +142,73 @@ function validateAndSetUInt32(message, element, min, max) {
     }
 }
 
+function validateAndSetTactorGain(tactor, element) {
+    const value = parseInt(element.value, 10);
+    if (value >= 0 && value <= 100) {
+        bleInstance.setTactorGain(tactor, Math.round(value * TACTOR_UNITY_GAIN / 100));
+    } else {
+        alert('Gain must be between 0 and 100.');
+        element.value = element.dataset.prevValue || 100;
+    }
+}
+
+/** Number of wiring and gain inputs, one per PWM channel */
+const MAX_TACTORS = 12;
+
+/**
+ * Sends the tactor map of the wiring inputs, 1-based as on the board.
+ * The tactors are the inputs up to the first empty one.
+ */
+function applyTactorMap() {
+    const slots = [];
+    for (let tactor = 0; tactor < MAX_TACTORS; tactor++) {
+	const text = document.getElementById('s_map' + tactor).value;
+	if (text == '') { break; }
+	const value = parseInt(text, 10);
+	if (!(value >= 1 && value <= 12) || slots.includes(value - 1)) {
+	    alert('Every tactor needs its own PWM channel between 1 and 12.');
+	    updateTactorMap();
+	    return;
+	}
+	slots.push(value - 1);
+    }
+    if (slots.length == 0) {
+	alert('Wire at least one tactor.');
+	updateTactorMap();
+	return;
+    }
+    // the gains move with the tactors
+    bleInstance.setTactorMap(slots)?.then(() => bleInstance.requestTactorGains());
+}
+
+/**
+ * Sends the channel groups input, the 1-based stream channel of every
+ * tactor, empty for the default groups
+ */
+function applyChannelGroups() {
+    const text = document.getElementById('s_groups').value.trim();
+    const groups = text == '' ? [] : text.split(/[\s,]+/).map(c => parseInt(c, 10) - 1);
+    if (groups.some(c => !(c >= 0 && c < 12))) {
+	alert('Channels must be between 1 and 12.');
+	return;
+    }
+    // the device ignores invalid groups, show what it plays
+    bleInstance.setChannelGroups(groups)?.then(() => bleInstance.requestSettingsBatch());
+}
+
+function uploadPatternJson(text) {
+    if (text.trim() == '') {
+	bleInstance.uploadPattern(new Uint8Array(0));
+	return;
+    }
+    try {
+	const pattern = JSON.parse(text);
+	bleInstance.uploadPattern(makePattern(pattern.period, pattern.events));
+    } catch (error) {
+	alert('Invalid pattern: ' + error.message);
+    }
+}
+
 function validatePauzedCycles(element) {
     const value = parseInt(element.value, 10);
     const max = parseInt(document.getElementById('s_pauzecycleperiod').value, 10);
@@ -198,32 +265,81 @@ function updateStreamConnectionState() {
     document.getElementById('a_running').checked = bleInstance.a_running;
     document.getElementById('a_runningsince').value = msToTime(Number(bleInstance.a_runningsince));
     document.getElementById('a_battery').value = bleInstance.a_battery;
+    document.getElementById('a_seed').value = bleInstance.a_seed;
+    document.getElementById('a_late_sequences').value = bleInstance.a_late_sequences.join(' / ')
+	+ ', underruns ' + bleInstance.a_underruns;
     
     if(bleInstance.connected && bleInstance.a_running) {
 	document.getElementById('toggleStream').innerHTML = 'Stop Stream';	      
-	document.getElementById('s_volume').disabled = true;
-	document.getElementById('s_volume_text').disabled = true;
-	document.getElementById('s_chan8').disabled = true;
-	document.getElementById('s_stimfreq').disabled = true;
-	document.getElementById('s_stimdur').disabled = true;
-	document.getElementById('s_cycleperiod').disabled = true;
-	document.getElementById('s_pauzecycleperiod').disabled = true;
-	document.getElementById('s_pauzedcycles').disabled = true;
-	document.getElementById('s_jitter').disabled = true;
-	document.getElementById('s_test_mode').disabled = true;	      
     } else {
 	document.getElementById('toggleStream').innerHTML = 'Start Stream';
-	document.getElementById('s_volume').disabled = false;
-	document.getElementById('s_volume_text').disabled = false;
-	document.getElementById('s_chan8').disabled = false;
-	document.getElementById('s_stimfreq').disabled = false;
-	document.getElementById('s_stimdur').disabled = false;
-	document.getElementById('s_cycleperiod').disabled = false;
-	document.getElementById('s_pauzecycleperiod').disabled = false;
-	document.getElementById('s_pauzedcycles').disabled = false;
-	document.getElementById('s_jitter').disabled = false;
-	document.getElementById('s_test_mode').disabled = false;	      
     }
+
+    // settings also apply while running, from the next cycle on
+    for (const id of ['s_volume', 's_volume_text', 's_chan8', 's_stimfreq', 's_stimdur',
+		      's_rampdur', 's_waveform', 's_seed', 's_pattern', 's_pattern_upload',
+		      's_cycleperiod', 's_pauzecycleperiod', 's_pauzedcycles', 's_jitter',
+		      's_test_mode']) {
+	document.getElementById(id).disabled = false;
+    }
+    setTactorGainsDisabled(!bleInstance.connected);
+}
+
+function setTactorGainsDisabled(disabled) {
+    for (let tactor = 0; tactor < MAX_TACTORS; tactor++) {
+	for (const id of ['s_gain', 's_map']) {
+	    const element = document.getElementById(id + tactor);
+	    if (element) { element.disabled = disabled; }
+	}
+    }
+    for (const id of ['applyTactorMap', 's_groups', 'applyChannelGroups']) {
+	const element = document.getElementById(id);
+	if (element) { element.disabled = disabled; }
+    }
+}
+
+/**
+ * On receive tactor gains from BLE, update the calibration inputs.
+ */
+function updateTactorGains() {
+    const gains = bleInstance.s_tactor_gains;
+    for (let tactor = 0; tactor < MAX_TACTORS; tactor++) {
+	const element = document.getElementById('s_gain' + tactor);
+	if (element) {
+	    element.value = tactor < gains.length ?
+		Math.round(gains[tactor] * 100 / TACTOR_UNITY_GAIN) : '';
+	}
+    }
+}
+
+/**
+ * On receive of the tactor map from BLE, update the wiring inputs.
+ */
+function updateTactorMap() {
+    const map = bleInstance.s_tactor_map;
+    for (let tactor = 0; tactor < MAX_TACTORS; tactor++) {
+	const element = document.getElementById('s_map' + tactor);
+	if (element) {
+	    element.value = tactor < map.length ? map[tactor] + 1 : '';
+	}
+    }
+}
+
+
+/**
+ * On receive of the PWM interrupt profile, show the durations and
+ * the share of the interval between interrupts the slowest one took
+ */
+function updateIsrProfile() {
+    const p = bleInstance.a_isr_profile;
+    const us = (v) => v.toFixed(1);
+    document.getElementById('a_isr_duration').value =
+	p.count ? us(p.min_us) + ' / ' + us(p.avg_us) + ' / ' + us(p.max_us) + ' us' : '-';
+    document.getElementById('a_isr_gap').value =
+	p.count > 1 ? us(p.gap_min_us) + ' / ' + us(p.gap_avg_us) + ' / ' + us(p.gap_max_us) + ' us' : '-';
+    document.getElementById('a_isr_load').value =
+	p.gap_avg_us ? Math.round(100 * p.max_us / p.gap_avg_us) + ' %' : '-';
+    document.getElementById('a_isr_histogram').value = p.histogram.join(' ');
 }
 
 
@@ -237,10 +353,14 @@ function updateBLEConnectionState() {
 	document.getElementById('clientConnectButton').innerHTML = 'Disconnect';
 	document.getElementById('toggleStream').disabled = false;
 	document.getElementById('refreshButton').disabled = false;	      
+	document.getElementById('isrProfileButton').disabled = false;
+	document.getElementById('isrProfileResetButton').disabled = false;
     } else {
 	document.getElementById('clientConnectButton').innerHTML = 'Connect';
 	document.getElementById('toggleStream').disabled = true;
 	document.getElementById('refreshButton').disabled = true;
+	document.getElementById('isrProfileButton').disabled = true;
+	document.getElementById('isrProfileResetButton').disabled = true;
     }
 
     updateStreamConnectionState();
@@ -296,12 +416,15 @@ function updateFromSettingsBatch() {
     document.getElementById('s_chan8').checked = bleInstance.s_chan8;
     document.getElementById('s_stimfreq').value = bleInstance.s_stimfreq;
     document.getElementById('s_stimdur').value = bleInstance.s_stimduration;
+    document.getElementById('s_rampdur').value = bleInstance.s_rampduration;
+    document.getElementById('s_seed').value = bleInstance.s_seed;
     document.getElementById('s_cycleperiod').value = bleInstance.s_cycleperiod;
     document.getElementById('s_pauzecycleperiod').value = bleInstance.s_pauzecycleperiod;
     document.getElementById('s_pauzedcycles').value = bleInstance.s_pauzedcycles;
     document.getElementById('s_jitter').value = bleInstance.s_jitter;
     document.getElementById('s_single_channel').value = bleInstance.s_single_channel;
     document.getElementById('s_test_mode').checked = bleInstance.s_testmode;
+    document.getElementById('s_groups').value = bleInstance.s_channel_groups.map(c => c + 1).join(', ');
 
     document.getElementById('s_single_channel').disabled = !bleInstance.s_testmode;
 }
@@ -358,7 +481,11 @@ var bleInstance = new BleManager(logFunction,
 				 updateBLEConnectionState,
 				 updateVolume,
 				 updateStreamConnectionState,
-				 updateFromSettingsBatch);
+				 updateFromSettingsBatch,
+				 noOp,
+				 updateTactorGains,
+				 updateIsrProfile,
+				 updateTactorMap);
 
 
 